@@ -0,0 +1,23 @@
+# write a map file for benchmarking with the given number of mappings and 
+#  mix of inputs (button, axis, mixed, or filtered for axes with smoothing 
+#  and a deadband), spread over all 256 inputs of each kind and splitting 
+#  each input into more ranges as the map gets bigger
+BEGIN {
+  per_input = int((size + 255) / 256);
+  for (i = 0; i < size; i++) {
+    number = i % 256;
+    part = int(i / 256);
+    kind = mix;
+    if (mix == "mixed") kind = (i % 2) ? "button" : "axis";
+    if (kind == "button") {
+      # buttons only have two values, so more mappings play chords
+      printf("button %d => note %d\n", number, (number + part) % 128);
+    }
+    else {
+      low = -32767 + int((65534 * part) / per_input);
+      high = -32767 + int((65534 * (part + 1)) / per_input);
+      printf("axis %d [%d..%d] => control %d%s\n", number, low, high, 
+        number % 128, (kind == "filtered") ? " smooth deadband 50" : "");
+    }
+  }
+}
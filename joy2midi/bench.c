@@ -0,0 +1,226 @@
+#include <stdlib.h>
+#include <time.h>
+
+#include "bench.h"
+#include "output.h"
+
+// whether allocator calls are being counted
+static int counting = 0;
+// the number of allocator calls counted
+static unsigned long allocations = 0;
+
+// replacing the allocator is only for the benchmark build (see the bench 
+//  target in the Makefile), so the program people run uses the C library's 
+//  allocator directly
+#ifdef BENCH_ALLOCATIONS
+
+// the allocator functions from the C library, which the wrappers below 
+//  pass through to (glibc exports these for exactly this purpose)
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void __libc_free(void *pointer);
+
+void *malloc(size_t size) {
+  if (counting) __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+  return(__libc_malloc(size));
+}
+
+void *calloc(size_t count, size_t size) {
+  if (counting) __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+  return(__libc_calloc(count, size));
+}
+
+void *realloc(void *pointer, size_t size) {
+  if (counting) __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+  return(__libc_realloc(pointer, size));
+}
+
+void free(void *pointer) {
+  __libc_free(pointer);
+}
+
+#endif
+
+int bench_counts_allocations(void) {
+#ifdef BENCH_ALLOCATIONS
+  return(1);
+#else
+  return(0);
+#endif
+}
+
+void bench_count_allocations(int enabled) {
+  __atomic_store_n(&counting, enabled, __ATOMIC_SEQ_CST);
+}
+
+unsigned long bench_allocations(void) {
+  return(__atomic_load_n(&allocations, __ATOMIC_SEQ_CST));
+}
+
+uint64_t bench_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return(((uint64_t)now.tv_sec * 1000000000) + now.tv_nsec);
+}
+
+// add an event if there's room for it
+static int add_event(JoystickEvent *events, int count, int max, 
+                     int kind, int number, int value) {
+  if (count >= max) return(count);
+  events[count].time = 0;
+  events[count].type = (kind == INPUT_AXIS) ? JS_EVENT_AXIS : JS_EVENT_BUTTON;
+  events[count].number = number;
+  events[count].value = value;
+  return(count + 1);
+}
+
+int bench_synthesize(const MapTable *table, JoystickEvent *events, int max) {
+  int kind, number, i, count = 0;
+  for (kind = 0; kind < INPUT_KINDS; kind++) {
+    for (number = 0; number < INPUT_NUMBERS; number++) {
+      const MapBucket *bucket = &table->buckets[kind][number];
+      for (i = 0; i < bucket->count; i++) {
+        const MapInterval *interval = &bucket->intervals[i];
+        // sweep up and back down through each interval
+        count = add_event(events, count, max, kind, number, interval->min);
+        count = add_event(events, count, max, kind, number, 
+          interval->min + ((interval->max - interval->min) / 2));
+        count = add_event(events, count, max, kind, number, interval->max);
+        count = add_event(events, count, max, kind, number, 
+          interval->min + ((interval->max - interval->min) / 4));
+      }
+    }
+  }
+  return(count);
+}
+
+double bench_lookup(const MapTable *table, const JoystickEvent *events, 
+                    int count) {
+  // repeat the lookups enough times to get a stable measurement
+  const long target = 10000000;
+  long i, lookups = 0;
+  volatile uintptr_t sink = 0;
+  if (count <= 0) return(0.0);
+  uint64_t start = bench_now();
+  while (lookups < target) {
+    for (i = 0; i < count; i++) {
+      int kind = (events[i].type == JS_EVENT_AXIS) ? INPUT_AXIS : INPUT_BUTTON;
+      sink += (uintptr_t)table_lookup(table, kind, 
+        events[i].number, events[i].value);
+    }
+    lookups += count;
+  }
+  return((double)(bench_now() - start) / lookups);
+}
+
+// start measuring a stage
+static void start_stage(uint64_t *start, unsigned long *allocated) {
+  *allocated = bench_allocations();
+  bench_count_allocations(1);
+  *start = bench_now();
+}
+
+// finish measuring a stage that handled the given number of things
+static BenchCost end_stage(uint64_t start, unsigned long allocated, 
+                           long count) {
+  BenchCost cost = { 0.0, 0.0 };
+  uint64_t elapsed = bench_now() - start;
+  bench_count_allocations(0);
+  if (count <= 0) return(cost);
+  cost.ns = (double)elapsed / count;
+  cost.allocations = (double)(bench_allocations() - allocated) / count;
+  return(cost);
+}
+
+BenchCost bench_filter(const MapTable *table, const JoystickEvent *events, 
+                       int count) {
+  // repeat the events enough times to get a stable measurement
+  const long target = 1000000;
+  long i, filtered = 0;
+  uint64_t start, time = 0;
+  unsigned long allocated;
+  volatile int sink = 0;
+  BenchCost none = { 0.0, 0.0 };
+  if (count <= 0) return(none);
+  // filter with state of our own, like a device does
+  int filter_count = 0;
+  const Mapping *mapping;
+  for (mapping = table->mappings; mapping != NULL; 
+       mapping = (const Mapping *)mapping->next) {
+    if (mapping->filter_index >= filter_count) 
+      filter_count = mapping->filter_index + 1;
+  }
+  FilterState *states = (FilterState *)calloc(
+    (filter_count > 0) ? filter_count : 1, sizeof(FilterState));
+  if (states == NULL) return(none);
+  start_stage(&start, &allocated);
+  while (filtered < target) {
+    for (i = 0; i < count; i++) {
+      int kind = (events[i].type == JS_EVENT_AXIS) ? INPUT_AXIS : INPUT_BUTTON;
+      const MapInterval *interval = table_lookup(table, kind, 
+        events[i].number, events[i].value);
+      // one event per millisecond
+      time += 1000;
+      filtered++;
+      if (interval == NULL) continue;
+      int j;
+      for (j = 0; j < interval->count; j++) {
+        Mapping *mapping = interval->mappings[j];
+        int value = events[i].value;
+        if (mapping->filter_index < 0) continue;
+        sink += filter_input(&mapping->options.filter, 
+          &states[mapping->filter_index], mapping->inspec.min, 
+          mapping->inspec.max, time, &value);
+      }
+    }
+  }
+  BenchCost cost = end_stage(start, allocated, filtered);
+  free(states);
+  return(cost);
+}
+
+// discard a message
+static int discard(void *context, int32_t time, 
+                   const uint8_t *data, size_t size) {
+  return(1);
+}
+
+BenchCost bench_queue(int port_count) {
+  // about as many messages as there's room for in a period
+  const int batch = 32;
+  const long target = 10000000;
+  const uint32_t nframes = 64;
+  MidiEvent events[batch];
+  MidiSink sink = { discard, NULL };
+  uint32_t period_start = nframes;
+  uint64_t start;
+  unsigned long allocated;
+  long sent = 0;
+  int i, port;
+  // turn coalescing off so every message goes through
+  output_init(port_count, -1, 48000);
+  for (i = 0; i < batch; i++) {
+    events[i].size = 3;
+    events[i].group = MIDI_GROUP_NONE;
+    events[i].port = i % port_count;
+    events[i].spilled = 0;
+    events[i].data[0] = 0xB0;
+    events[i].data[1] = i;
+    events[i].data[2] = 64;
+  }
+  start_stage(&start, &allocated);
+  while (sent < target) {
+    // queue messages from an input in the last period and send them
+    for (i = 0; i < batch; i++) events[i].time = period_start - nframes;
+    output_send_batch(events, batch);
+    output_begin_period();
+    for (port = 0; port < port_count; port++) {
+      output_process(port, &sink, period_start, nframes);
+    }
+    output_end_period();
+    period_start += nframes;
+    sent += batch;
+  }
+  return(end_stage(start, allocated, sent));
+}
@@ -0,0 +1,41 @@
+#ifndef JOY2MIDI_BENCH_H
+#define JOY2MIDI_BENCH_H
+
+#include <stdint.h>
+
+#include "input.h"
+#include "mapping.h"
+
+// get whether calls to the allocator can be counted, which only the 
+//  benchmark build does
+int bench_counts_allocations(void);
+// start or stop counting calls to the allocator
+void bench_count_allocations(int enabled);
+// get the number of allocator calls counted so far
+unsigned long bench_allocations(void);
+// get a monotonic time in nanoseconds
+uint64_t bench_now(void);
+// fill in events that sweep every input the table maps, returning the 
+//  number of events written
+int bench_synthesize(const MapTable *table, JoystickEvent *events, int max);
+// the cost of one stage of translation
+typedef struct {
+  // the average time in nanoseconds
+  double ns;
+  // the average number of allocator calls
+  double allocations;
+} BenchCost;
+
+// measure the average cost in nanoseconds of looking up the given events
+double bench_lookup(const MapTable *table, const JoystickEvent *events, 
+                    int count);
+// measure the cost per event of filtering the values of the given events 
+//  for every mapping they match
+BenchCost bench_filter(const MapTable *table, const JoystickEvent *events, 
+                       int count);
+// measure the cost per message of passing messages for the given number 
+//  of ports through the output queues to a sink that discards them (call 
+//  only when nothing else is using the output)
+BenchCost bench_queue(int port_count);
+
+#endif
@@ -0,0 +1,190 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "capture.h"
+#include "ring.h"
+#include "serialize.h"
+
+// ticks per quarter note in the file, which at the default tempo of 120 
+//  beats per minute makes a tick about half a millisecond
+#define CAPTURE_DIVISION 960
+// microseconds per quarter note (120 beats per minute)
+#define CAPTURE_TEMPO 500000
+#define CAPTURE_TICKS_PER_SECOND \
+  ((CAPTURE_DIVISION * 1000000ULL) / CAPTURE_TEMPO)
+// the offset in the file of the track length
+#define CAPTURE_LENGTH_OFFSET 18
+// the nanoseconds the writer waits between emptying the queue
+#define CAPTURE_INTERVAL 10000000
+// the bytes to buffer before writing to the file
+#define CAPTURE_BUFFER_SIZE 65536
+
+// the file being written, or NULL if not capturing
+static FILE *file = NULL;
+static char file_buffer[CAPTURE_BUFFER_SIZE];
+// messages passed from the output thread to the writer thread
+static MidiRing queue;
+// the thread that writes messages to the file
+static pthread_t writer;
+// whether the output thread should queue messages
+static int capturing = 0;
+// whether the writer thread should keep running
+static int running = 0;
+// the output clock, and the time of the last message written on it
+static uint32_t rate;
+static uint32_t last_frame;
+// frames and ticks from the start of the capture to the last message
+static uint64_t elapsed_frames;
+static uint64_t elapsed_ticks;
+// the number of bytes in the track so far
+static uint32_t track_length;
+// whether writing to the file has failed
+static int failed;
+static MidiSerializer serializer;
+
+// write bytes to the track
+static void write_track(const uint8_t *data, size_t size) {
+  if (fwrite(data, 1, size, file) != size) failed = 1;
+  track_length += size;
+}
+
+// write a number in the variable-length format of delta times
+static void write_variable(uint32_t value) {
+  uint8_t bytes[5];
+  int i, count = 0;
+  do {
+    bytes[count++] = value & 0x7F;
+    value >>= 7;
+  } while (value > 0);
+  // the most significant group comes first, with the high bit set on all 
+  //  but the last byte
+  uint8_t out[5];
+  for (i = 0; i < count; i++) {
+    out[i] = bytes[count - 1 - i] | ((i < count - 1) ? 0x80 : 0x00);
+  }
+  write_track(out, count);
+}
+
+// write a 32-bit number with the most significant byte first
+static void write_uint32(uint8_t *out, uint32_t value) {
+  out[0] = (value >> 24) & 0xFF;
+  out[1] = (value >> 16) & 0xFF;
+  out[2] = (value >> 8) & 0xFF;
+  out[3] = value & 0xFF;
+}
+
+// write the queued messages to the file with their delta times
+static void drain(void) {
+  MidiEvent *event;
+  uint8_t buffer[MIDI_EVENT_MAX];
+  while ((event = ring_peek(&queue)) != NULL) {
+    // a message can't go before the one ahead of it in the file
+    int32_t frames = (int32_t)(event->time - last_frame);
+    if (frames > 0) {
+      elapsed_frames += frames;
+      last_frame = event->time;
+    }
+    uint64_t ticks = (elapsed_frames * CAPTURE_TICKS_PER_SECOND) / rate;
+    write_variable((uint32_t)(ticks - elapsed_ticks));
+    elapsed_ticks = ticks;
+    write_track(buffer, 
+      serializer_write(&serializer, event->data, event->size, buffer));
+    ring_pop(&queue);
+  }
+}
+
+// write queued messages to the file every so often until stopped
+static void *write_thread(void *arg) {
+  struct timespec wait = { 0, CAPTURE_INTERVAL };
+  while (__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+    drain();
+    nanosleep(&wait, NULL);
+  }
+  drain();
+  return(NULL);
+}
+
+int capture_start(const char *path, uint32_t sample_rate, uint32_t frame) {
+  // a header for one track, then a track with a placeholder length that 
+  //  starts by setting the tempo
+  static const uint8_t header[] = {
+    'M', 'T', 'h', 'd', 0, 0, 0, 6, 
+    0, 0,                                      // format 0
+    0, 1,                                      // one track
+    (CAPTURE_DIVISION >> 8) & 0x7F, CAPTURE_DIVISION & 0xFF, 
+    'M', 'T', 'r', 'k', 0, 0, 0, 0
+  };
+  static const uint8_t tempo[] = {
+    0x00, 0xFF, 0x51, 0x03, 
+    (CAPTURE_TEMPO >> 16) & 0xFF, (CAPTURE_TEMPO >> 8) & 0xFF, 
+    CAPTURE_TEMPO & 0xFF
+  };
+  file = fopen(path, "wb");
+  if (file == NULL) { fprintf(stderr, 
+    "ERROR: Failed to open '%s' for capturing MIDI.\n", path);
+    return(0);
+  }
+  setvbuf(file, file_buffer, _IOFBF, sizeof(file_buffer));
+  ring_init(&queue);
+  serializer_init(&serializer);
+  rate = (sample_rate > 0) ? sample_rate : 48000;
+  last_frame = frame;
+  elapsed_frames = elapsed_ticks = 0;
+  failed = 0;
+  if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) failed = 1;
+  track_length = 0;
+  write_track(tempo, sizeof(tempo));
+  __atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+  if (pthread_create(&writer, NULL, write_thread, NULL) != 0) {
+    fprintf(stderr, "ERROR: Failed to start capturing MIDI.\n");
+    running = 0;
+    fclose(file);
+    file = NULL;
+    return(0);
+  }
+  __atomic_store_n(&capturing, 1, __ATOMIC_RELEASE);
+  return(1);
+}
+
+int capture_active(void) {
+  return(__atomic_load_n(&capturing, __ATOMIC_ACQUIRE));
+}
+
+void capture_message(uint32_t frame, const uint8_t *data, size_t size) {
+  MidiEvent event;
+  if (! __atomic_load_n(&capturing, __ATOMIC_ACQUIRE)) return;
+  if (size > MIDI_EVENT_MAX) return;
+  event.time = frame;
+  event.size = size;
+  event.group = MIDI_GROUP_NONE;
+  event.port = 0;
+  event.spilled = 0;
+  memcpy(event.data, data, size);
+  ring_push(&queue, &event);
+}
+
+int capture_stop(void) {
+  static const uint8_t end[] = { 0x00, 0xFF, 0x2F, 0x00 };
+  uint8_t length[4];
+  if (file == NULL) return(1);
+  // stop taking messages and write the ones already queued
+  __atomic_store_n(&capturing, 0, __ATOMIC_RELEASE);
+  __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+  pthread_join(writer, NULL);
+  write_track(end, sizeof(end));
+  // fill in the length of the track now that it's known
+  write_uint32(length, track_length);
+  if ((fseek(file, CAPTURE_LENGTH_OFFSET, SEEK_SET) != 0) || 
+      (fwrite(length, 1, sizeof(length), file) != sizeof(length))) failed = 1;
+  if (fclose(file) != 0) failed = 1;
+  file = NULL;
+  uint32_t dropped = ring_dropped(&queue);
+  if (dropped > 0) {
+    fprintf(stderr, "WARNING: %u messages didn't fit in the capture queue.\n", 
+      dropped);
+  }
+  if (failed) fprintf(stderr, "ERROR: Failed to write the MIDI capture.\n");
+  return(! failed);
+}
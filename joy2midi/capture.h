@@ -0,0 +1,20 @@
+#ifndef JOY2MIDI_CAPTURE_H
+#define JOY2MIDI_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// start capturing sent messages to a type 0 Standard MIDI File at the 
+//  given path, timed from the given frame on an output clock with the 
+//  given sample rate, returning 0 if the file can't be written
+int capture_start(const char *path, uint32_t sample_rate, uint32_t frame);
+// get whether messages are being captured
+int capture_active(void);
+// add a message sent at an absolute frame time to the capture if there is 
+//  one, which never blocks (output thread only)
+void capture_message(uint32_t frame, const uint8_t *data, size_t size);
+// write everything captured, finish the file and close it, returning 0 if 
+//  it couldn't be written
+int capture_stop(void);
+
+#endif
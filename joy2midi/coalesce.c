@@ -0,0 +1,128 @@
+#include <string.h>
+
+#include "coalesce.h"
+
+void coalesce_init(Coalescer *coalescer, int enabled, uint32_t window) {
+  memset(coalescer, 0, sizeof(Coalescer));
+  coalescer->enabled = enabled;
+  coalescer->window = window;
+}
+
+int coalesce_key(const MidiEvent *event) {
+  if (event->size < 3) return(-1);
+  // the parts of an NRPN depend on which parameter was selected last, so 
+  //  they have to go out exactly as they came in
+  if (event->group == MIDI_GROUP_NRPN) return(-1);
+  int status = event->data[0] & 0xF0;
+  int channel = event->data[0] & 0x0F;
+  // both halves of a 14-bit controller share the key of its MSB
+  if (event->group == MIDI_GROUP_CONTROL14) 
+    return((channel * 129) + (event->data[1] & 0x1F));
+  if (status == 0xB0) return((channel * 129) + (event->data[1] & 0x7F));
+  if (status == 0xE0) return((channel * 129) + 128);
+  return(-1);
+}
+
+// when an older event is dropped in favor of a newer one with the same key, 
+//  keep any 14-bit controller MSB the newer one left out because it was 
+//  unchanged from the older one
+static void merge_group(MidiEvent *newer, const MidiEvent *older) {
+  int i;
+  if ((newer->group != MIDI_GROUP_CONTROL14) || (newer->size != 3)) return;
+  for (i = 0; i + 3 <= older->size; i += 3) {
+    if (older->data[i + 1] < 32) {
+      memmove(newer->data + 3, newer->data, 3);
+      memcpy(newer->data, older->data + i, 3);
+      newer->size = 6;
+      return;
+    }
+  }
+}
+
+int coalesce_due(Coalescer *coalescer, uint32_t period_start, 
+                 uint32_t nframes, DueEvent *due) {
+  int key, i, count = 0;
+  if ((! coalescer->enabled) || (coalescer->window == 0)) return(0);
+  for (key = 0; key < COALESCE_KEYS; key++) {
+    if (! coalescer->is_held[key]) continue;
+    int32_t time = (int32_t)(coalescer->next_allowed[key] - period_start);
+    if (time >= (int32_t)nframes) continue;
+    if (count >= COALESCE_MAX_DUE) break;
+    if (time < 0) time = 0;
+    // insert in order of time
+    for (i = count; (i > 0) && (due[i - 1].time > time); i--) {
+      due[i] = due[i - 1];
+    }
+    due[i].time = time;
+    due[i].event = coalescer->held[key];
+    count++;
+    coalescer->is_held[key] = 0;
+    coalescer->next_allowed[key] = period_start + time + coalescer->window;
+  }
+  return(count);
+}
+
+void coalesce_period(Coalescer *coalescer, MidiEvent **events, 
+                     const uint32_t *times, int count) {
+  int i, key;
+  // the index of the last message for each key in the period, plus one
+  static int kept[COALESCE_KEYS];
+  if (! coalescer->enabled) return;
+  // keep only the last message for each key in the period
+  memset(kept, 0, sizeof(kept));
+  for (i = count - 1; i >= 0; i--) {
+    key = coalesce_key(events[i]);
+    if (key < 0) continue;
+    // messages left over from an earlier period were counted then
+    if (! events[i]->spilled) coalescer->continuous++;
+    if (kept[key]) {
+      merge_group(events[kept[key] - 1], events[i]);
+      events[i]->size = 0;
+      coalescer->coalesced++;
+    }
+    else {
+      kept[key] = i + 1;
+    }
+  }
+  if (coalescer->window == 0) return;
+  // hold back messages that come too soon after the last one for their key
+  for (i = 0; i < count; i++) {
+    if (events[i]->size == 0) continue;
+    key = coalesce_key(events[i]);
+    if (key < 0) continue;
+    // (comparing the wait to the window ignores keys never sent before)
+    int32_t wait = (int32_t)(coalescer->next_allowed[key] - times[i]);
+    if ((wait > 0) && (wait < (int32_t)coalescer->window)) {
+      // a newer message replaces one that's already waiting
+      if (coalescer->is_held[key]) {
+        merge_group(events[i], &coalescer->held[key]);
+        coalescer->coalesced++;
+      }
+      coalescer->held[key] = *events[i];
+      coalescer->is_held[key] = 1;
+      events[i]->size = 0;
+    }
+    else {
+      if (coalescer->is_held[key]) {
+        merge_group(events[i], &coalescer->held[key]);
+        coalescer->is_held[key] = 0;
+        coalescer->coalesced++;
+      }
+      coalescer->next_allowed[key] = times[i] + coalescer->window;
+    }
+  }
+}
+
+void coalesce_hold(Coalescer *coalescer, const MidiEvent *event, 
+                   uint32_t time) {
+  int key = coalesce_key(event);
+  if (key < 0) return;
+  // anything already held is newer
+  if (coalescer->is_held[key]) {
+    merge_group(&coalescer->held[key], event);
+    return;
+  }
+  coalescer->held[key] = *event;
+  coalescer->is_held[key] = 1;
+  coalescer->next_allowed[key] = time;
+}
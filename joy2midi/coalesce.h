@@ -0,0 +1,55 @@
+#ifndef JOY2MIDI_COALESCE_H
+#define JOY2MIDI_COALESCE_H
+
+#include <stdint.h>
+
+#include "ring.h"
+
+// one key for each controller and pitch bend on each channel
+#define COALESCE_KEYS (16 * 129)
+// the most held messages that can come due in one period
+#define COALESCE_MAX_DUE 256
+
+// state for reducing continuous controller and bend messages so that 
+//  only the latest one for each controller goes out in each period or 
+//  time window, while notes always pass through
+typedef struct {
+  // whether coalescing is turned on
+  int enabled;
+  // the minimum number of frames between messages for the same 
+  //  controller, or 0 to allow one per period
+  uint32_t window;
+  // the earliest frame the next message for each key can be sent at
+  uint32_t next_allowed[COALESCE_KEYS];
+  // the latest message for each key waiting for its window to pass
+  MidiEvent held[COALESCE_KEYS];
+  uint8_t is_held[COALESCE_KEYS];
+  // the number of controller and bend messages that came in
+  uint32_t continuous;
+  // the number of those messages that were dropped
+  uint32_t coalesced;
+} Coalescer;
+
+// a message scheduled for sending at a frame offset within a period
+typedef struct {
+  int32_t time;
+  MidiEvent event;
+} DueEvent;
+
+// reset the coalescer with a window in frames (not thread-safe)
+void coalesce_init(Coalescer *coalescer, int enabled, uint32_t window);
+// get the key for a message, or -1 if it must never be coalesced
+int coalesce_key(const MidiEvent *event);
+// collect held messages that come due in the period starting at the given 
+//  frame, in order of time, returning how many there are
+int coalesce_due(Coalescer *coalescer, uint32_t period_start, 
+                 uint32_t nframes, DueEvent *due);
+// filter the messages scheduled in a period, with times as absolute 
+//  frames, setting the size of dropped or held messages to zero
+void coalesce_period(Coalescer *coalescer, MidiEvent **events, 
+                     const uint32_t *times, int count);
+// hold a message that came due but couldn't be sent until the given frame
+void coalesce_hold(Coalescer *coalescer, const MidiEvent *event, 
+                   uint32_t time);
+
+#endif
@@ -0,0 +1,96 @@
+#include <string.h>
+
+#include "debounce.h"
+
+// a counter only written by the reader thread
+static uint32_t suppressed_events = 0;
+
+void debounce_init(DebounceState *state) {
+  memset(state, 0, sizeof(DebounceState));
+}
+
+int debounce_button(const DebounceSpec *spec, DebounceState *state, 
+                    int number, int value, uint64_t time) {
+  if ((number < 0) || (number >= DEBOUNCE_BUTTONS)) return(1);
+  int pressed = (value != 0);
+  if (state->releasing[number]) {
+    // a press before a held-back release is due cancels it as chatter, 
+    //  and another release leaves it held
+    if (pressed) {
+      state->releasing[number] = 0;
+      state->releasing_count--;
+    }
+    __atomic_store_n(&suppressed_events, suppressed_events + 1, 
+      __ATOMIC_RELAXED);
+    return(0);
+  }
+  if ((spec->press > 0) || (spec->release > 0)) {
+    if (state->known[number]) {
+      // a button going back to where it was after a change we ignored 
+      //  is more of the same chatter
+      int window = pressed ? spec->press : spec->release;
+      uint64_t due = state->changed[number] + ((uint64_t)window * 1000);
+      if (pressed == state->pressed[number]) {
+        __atomic_store_n(&suppressed_events, suppressed_events + 1, 
+          __ATOMIC_RELAXED);
+        return(0);
+      }
+      if (time < due) {
+        // hold a release back until its window is up, so a quick tap 
+        //  can't leave a button down
+        if (! pressed) {
+          state->releasing[number] = 1;
+          state->release_due[number] = due;
+          state->releasing_count++;
+          return(0);
+        }
+        __atomic_store_n(&suppressed_events, suppressed_events + 1, 
+          __ATOMIC_RELAXED);
+        return(0);
+      }
+    }
+  }
+  // keep track even when debouncing is off, so it can be turned on by 
+  //  reloading the map file
+  state->known[number] = 1;
+  state->pressed[number] = pressed;
+  state->changed[number] = time;
+  return(1);
+}
+
+int debounce_next(const DebounceState *state, uint64_t *due) {
+  int i, found = 0;
+  if (state->releasing_count == 0) return(0);
+  for (i = 0; i < DEBOUNCE_BUTTONS; i++) {
+    if (! state->releasing[i]) continue;
+    if ((! found) || (state->release_due[i] < *due)) 
+      *due = state->release_due[i];
+    found = 1;
+  }
+  return(found);
+}
+
+int debounce_release(DebounceState *state, uint64_t before, 
+                     int *number, uint64_t *time) {
+  int i, found = -1;
+  if (state->releasing_count == 0) return(0);
+  // take the earliest one so releases go out in order
+  for (i = 0; i < DEBOUNCE_BUTTONS; i++) {
+    if ((! state->releasing[i]) || (state->release_due[i] >= before)) 
+      continue;
+    if ((found < 0) || 
+        (state->release_due[i] < state->release_due[found])) found = i;
+  }
+  if (found < 0) return(0);
+  state->releasing[found] = 0;
+  state->releasing_count--;
+  state->pressed[found] = 0;
+  state->changed[found] = state->release_due[found];
+  *number = found;
+  *time = state->release_due[found];
+  return(1);
+}
+
+uint32_t debounce_suppressed(void) {
+  return(__atomic_load_n(&suppressed_events, __ATOMIC_RELAXED));
+}
@@ -0,0 +1,55 @@
+#ifndef JOY2MIDI_DEBOUNCE_H
+#define JOY2MIDI_DEBOUNCE_H
+
+#include <stdint.h>
+
+// the number of buttons a device can report
+#define DEBOUNCE_BUTTONS 256
+
+// settings for ignoring chatter from buttons, which are off at 0
+typedef struct {
+  // milliseconds after a button is released during which presses are 
+  //  ignored
+  int press;
+  // milliseconds after a button is pressed during which releases are 
+  //  held back, so they're ignored if the button is pressed again and 
+  //  used when the time is up otherwise
+  int release;
+} DebounceSpec;
+
+// the state of debouncing one device's buttons (reader thread only)
+typedef struct {
+  // whether each button has reported anything yet
+  uint8_t known[DEBOUNCE_BUTTONS];
+  // whether each button is pressed, as far as what's been let through
+  uint8_t pressed[DEBOUNCE_BUTTONS];
+  // the time in microseconds each button last changed on the device's 
+  //  clock
+  uint64_t changed[DEBOUNCE_BUTTONS];
+  // whether each button has a release held back, and the time in 
+  //  microseconds it's due
+  uint8_t releasing[DEBOUNCE_BUTTONS];
+  uint64_t release_due[DEBOUNCE_BUTTONS];
+  // the number of releases held back
+  int releasing_count;
+} DebounceState;
+
+// reset to a state where no button has reported anything
+void debounce_init(DebounceState *state);
+// debounce a button event at the given time in microseconds on the 
+//  device's clock, returning 0 if it's chatter that should be ignored or 
+//  a release that was held back
+int debounce_button(const DebounceSpec *spec, DebounceState *state, 
+                    int number, int value, uint64_t time);
+// get the earliest time a held-back release is due, returning 0 if there 
+//  aren't any
+int debounce_next(const DebounceState *state, uint64_t *due);
+// take a held-back release that came due before the given time, setting 
+//  its button and the time it's due and returning 1, or return 0 if there 
+//  aren't any
+int debounce_release(DebounceState *state, uint64_t before, 
+                     int *number, uint64_t *time);
+// get the number of button events ignored as chatter so far
+uint32_t debounce_suppressed(void);
+
+#endif
@@ -0,0 +1,163 @@
+#include <string.h>
+#include <sys/ioctl.h>
+
+#include "evdev.h"
+
+// the number of bytes needed for a bitmask of the given number of bits
+#define BITMASK_BYTES(bits) (((bits) + 7) / 8)
+// test a bit in a bitmask
+#define TEST_BIT(mask, bit) ((mask)[(bit) / 8] & (1 << ((bit) % 8)))
+
+// number buttons in the order the joystick API uses, which puts the 
+//  joystick and gamepad buttons first and the miscellaneous ones last
+static void number_buttons(EvdevState *state, const uint8_t *supported) {
+  int code, number = 0;
+  for (code = BTN_JOYSTICK; code < KEY_CNT; code++) {
+    if ((TEST_BIT(supported, code)) && (number < EVDEV_MAX_NUMBER)) 
+      state->buttons[code] = number++;
+  }
+  for (code = BTN_MISC; code < BTN_JOYSTICK; code++) {
+    if ((TEST_BIT(supported, code)) && (number < EVDEV_MAX_NUMBER)) 
+      state->buttons[code] = number++;
+  }
+}
+
+void evdev_init(EvdevState *state, int fd) {
+  int code;
+  uint8_t keys[BITMASK_BYTES(KEY_CNT)];
+  uint8_t axes[BITMASK_BYTES(ABS_CNT)];
+  struct input_absinfo info;
+  state->fd = fd;
+  state->frame_count = 0;
+  state->dropping = 0;
+  for (code = 0; code < KEY_CNT; code++) state->buttons[code] = -1;
+  for (code = 0; code < ABS_CNT; code++) {
+    state->axes[code] = -1;
+    state->axis_min[code] = -32767;
+    state->axis_max[code] = 32767;
+  }
+  // without a device to ask what it has, assume events map directly
+  memset(keys, 0, sizeof(keys));
+  memset(axes, 0, sizeof(axes));
+  if ((fd < 0) || (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0)) {
+    for (code = BTN_JOYSTICK; code < KEY_CNT; code++) {
+      if (code - BTN_JOYSTICK < EVDEV_MAX_NUMBER) 
+        state->buttons[code] = code - BTN_JOYSTICK;
+    }
+    for (code = 0; code < ABS_CNT; code++) state->axes[code] = code;
+    return;
+  }
+  ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(axes)), axes);
+  number_buttons(state, keys);
+  int number = 0;
+  for (code = 0; code < ABS_CNT; code++) {
+    if (! TEST_BIT(axes, code)) continue;
+    state->axes[code] = number++;
+    if (ioctl(fd, EVIOCGABS(code), &info) >= 0) {
+      state->axis_min[code] = info.minimum;
+      state->axis_max[code] = info.maximum;
+    }
+  }
+}
+
+// scale an axis value into the joystick API's range
+static int16_t scale_axis(const EvdevState *state, int code, int32_t value) {
+  int64_t min = state->axis_min[code];
+  int64_t max = state->axis_max[code];
+  if (max <= min) return(0);
+  if (value < min) value = min;
+  if (value > max) value = max;
+  return((int16_t)((((value - min) * 65534) / (max - min)) - 32767));
+}
+
+// add an event to the frame being read, sending the frame early if it 
+//  somehow fills up
+static void add_event(EvdevState *state, uint64_t time, 
+                      int type, int number, int value, 
+                      EvdevFrameHandler handler, void *context) {
+  if (state->frame_count >= EVDEV_MAX_FRAME) {
+    handler(context, state->frame, state->frame_count);
+    state->frame_count = 0;
+  }
+  JoystickEvent *event = &state->frame[state->frame_count++];
+  event->time = time;
+  event->type = type;
+  event->number = number;
+  event->value = value;
+}
+
+// get the time of a raw event in microseconds
+static uint64_t event_time(const struct input_event *raw) {
+  return(((uint64_t)raw->input_event_sec * 1000000) + raw->input_event_usec);
+}
+
+// translate a raw event into the frame being read
+static void translate(EvdevState *state, const struct input_event *raw, 
+                      EvdevFrameHandler handler, void *context) {
+  uint64_t time = event_time(raw);
+  if ((raw->type == EV_KEY) && (raw->code < KEY_CNT)) {
+    int number = state->buttons[raw->code];
+    // key repeats aren't new presses
+    if ((number < 0) || (raw->value > 1)) return;
+    add_event(state, time, JS_EVENT_BUTTON, number, raw->value, 
+      handler, context);
+  }
+  else if ((raw->type == EV_ABS) && (raw->code < ABS_CNT)) {
+    int number = state->axes[raw->code];
+    if (number < 0) return;
+    add_event(state, time, JS_EVENT_AXIS, number, 
+      scale_axis(state, raw->code, raw->value), handler, context);
+  }
+}
+
+// read the whole state of the device into the frame after events were lost
+static void resync(EvdevState *state, uint64_t time, 
+                   EvdevFrameHandler handler, void *context) {
+  int code;
+  uint8_t keys[BITMASK_BYTES(KEY_CNT)];
+  struct input_absinfo info;
+  state->frame_count = 0;
+  if (state->fd < 0) return;
+  memset(keys, 0, sizeof(keys));
+  if (ioctl(state->fd, EVIOCGKEY(sizeof(keys)), keys) >= 0) {
+    for (code = 0; code < KEY_CNT; code++) {
+      if (state->buttons[code] < 0) continue;
+      add_event(state, time, JS_EVENT_BUTTON, state->buttons[code], 
+        TEST_BIT(keys, code) ? 1 : 0, handler, context);
+    }
+  }
+  for (code = 0; code < ABS_CNT; code++) {
+    if (state->axes[code] < 0) continue;
+    if (ioctl(state->fd, EVIOCGABS(code), &info) < 0) continue;
+    add_event(state, time, JS_EVENT_AXIS, state->axes[code], 
+      scale_axis(state, code, info.value), handler, context);
+  }
+}
+
+void evdev_decode(EvdevState *state, const struct input_event *raw, 
+                  int count, EvdevFrameHandler handler, void *context) {
+  int i, j;
+  for (i = 0; i < count; i++) {
+    if (raw[i].type == EV_SYN) {
+      if (raw[i].code == SYN_DROPPED) {
+        state->dropping = 1;
+        state->frame_count = 0;
+        continue;
+      }
+      if (raw[i].code != SYN_REPORT) continue;
+      // everything in the frame happened at the time of the report
+      uint64_t time = event_time(&raw[i]);
+      if (state->dropping) {
+        resync(state, time, handler, context);
+        state->dropping = 0;
+      }
+      for (j = 0; j < state->frame_count; j++) state->frame[j].time = time;
+      if (state->frame_count > 0) 
+        handler(context, state->frame, state->frame_count);
+      state->frame_count = 0;
+    }
+    else if (! state->dropping) {
+      translate(state, &raw[i], handler, context);
+    }
+  }
+}
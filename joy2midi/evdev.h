@@ -0,0 +1,51 @@
+#ifndef JOY2MIDI_EVDEV_H
+#define JOY2MIDI_EVDEV_H
+
+#include <stdint.h>
+
+#include <linux/input.h>
+
+#include "input.h"
+
+// the most raw events to read from a device at once (a page of events)
+#define EVDEV_BATCH_SIZE (4096 / sizeof(struct input_event))
+// the number of buttons that can be numbered, since event numbers are a byte
+#define EVDEV_MAX_NUMBER 256
+// the most translated events a frame can hold before it's sent early
+#define EVDEV_MAX_FRAME 256
+
+// translation state for a device using the evdev interface, which reports 
+//  changes in frames that end with a SYN_REPORT
+typedef struct EvdevState {
+  // the open device to query, or -1 for recorded events
+  int fd;
+  // the joystick button number for each key code, or -1 if unused
+  int16_t buttons[KEY_CNT];
+  // the joystick axis number for each absolute axis code, or -1 if unused
+  int16_t axes[ABS_CNT];
+  // the range of each absolute axis
+  int32_t axis_min[ABS_CNT];
+  int32_t axis_max[ABS_CNT];
+  // the events of the frame being read
+  JoystickEvent frame[EVDEV_MAX_FRAME];
+  int frame_count;
+  // set when the kernel's buffer overflowed, so that events are dropped 
+  //  until the next report and the device's state is read fresh
+  int dropping;
+} EvdevState;
+
+// a function to pass each complete frame of events to
+typedef void (*EvdevFrameHandler)(void *context, JoystickEvent *events, 
+                                  int count);
+
+// set up translation for an open device, numbering buttons and axes the 
+//  way the joystick API does, or for recorded events if fd is -1 (or the 
+//  device can't be queried), in which case buttons are numbered from 
+//  BTN_JOYSTICK and axes by their codes
+void evdev_init(EvdevState *state, int fd);
+// translate raw events, passing each frame to the handler when the 
+//  SYN_REPORT that ends it arrives, with all events stamped at its time
+void evdev_decode(EvdevState *state, const struct input_event *raw, 
+                  int count, EvdevFrameHandler handler, void *context);
+
+#endif
@@ -0,0 +1,115 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "filter.h"
+
+// the cutoff frequency in hertz for smoothing the speed of the input
+#define SPEED_CUTOFF 1.0
+// the shortest time in seconds to assume between inputs, which keeps 
+//  inputs stamped with the same time from looking infinitely fast
+#define MIN_STEP 0.001
+
+// counters only written by the reader thread
+static uint32_t smoothed_values = 0;
+static uint32_t deadband_values = 0;
+static uint32_t interval_values = 0;
+
+// get how far a low-pass filter with the given cutoff frequency moves toward 
+//  a new value after the given number of seconds
+static double smoothing_factor(double cutoff, double step) {
+  double tau = 1.0 / (2.0 * M_PI * cutoff);
+  return(1.0 / (1.0 + (tau / step)));
+}
+
+// count a value suppressed by a filter
+static void suppress(uint32_t *counter) {
+  __atomic_store_n(counter, *counter + 1, __ATOMIC_RELAXED);
+}
+
+// filter an input value, counting the values suppressed if counting is set, 
+//  and hold the input back for later if it hasn't been fully used
+static int filter_value(const FilterSpec *spec, FilterState *state, 
+                        int min, int max, uint64_t time, int *value, 
+                        int counting) {
+  int range = max - min;
+  int used = *value;
+  // values at the ends of the range always get through so that inputs 
+  //  come to rest exactly where they stop
+  int end = ((used == min) || (used == max));
+  state->input = used;
+  state->pending = 0;
+  if (! state->started) {
+    state->started = 1;
+    state->position = (range > 0) ? (double)(used - min) / range : 0.0;
+    state->speed = 0.0;
+    state->input_time = time;
+    state->used_time = time;
+    state->value = used;
+    return(1);
+  }
+  // smooth with a 1-euro filter, which follows the input more closely the 
+  //  faster it moves so that jitter is removed without lagging fast moves
+  if ((spec->cutoff > 0) && (range > 0)) {
+    double step = (time > state->input_time) ? 
+      (double)(time - state->input_time) / 1000000.0 : MIN_STEP;
+    if (step < MIN_STEP) step = MIN_STEP;
+    double x = (double)(used - min) / range;
+    state->speed += smoothing_factor(SPEED_CUTOFF, step) * 
+      (((x - state->position) / step) - state->speed);
+    double cutoff = spec->cutoff + (spec->beta * fabs(state->speed));
+    state->position += smoothing_factor(cutoff, step) * (x - state->position);
+    if (end) state->position = x;
+    used = min + (int)lround(state->position * range);
+    // keep settling toward an input that stops before smoothing catches up
+    if (used != state->input) {
+      state->pending = 1;
+      state->deadline = time + (FILTER_SETTLE_STEP * 1000);
+    }
+    state->input_time = time;
+    if (used == state->value) {
+      if (counting) suppress(&smoothed_values);
+      return(0);
+    }
+  }
+  state->input_time = time;
+  // ignore small moves from the last value used
+  if ((spec->deadband > 0) && (! end) && 
+      (abs(used - state->value) <= spec->deadband)) {
+    if (counting) suppress(&deadband_values);
+    return(0);
+  }
+  // limit how often values are used, sending the latest one when the 
+  //  interval is up
+  uint64_t interval = (uint64_t)spec->interval * 1000;
+  if ((spec->interval > 0) && (! end) && 
+      (time - state->used_time < interval)) {
+    if (counting) suppress(&interval_values);
+    if ((! state->pending) || (state->deadline < state->used_time + interval))
+      state->deadline = state->used_time + interval;
+    state->pending = 1;
+    return(0);
+  }
+  state->used_time = time;
+  state->value = used;
+  *value = used;
+  return(1);
+}
+
+int filter_input(const FilterSpec *spec, FilterState *state, 
+                 int min, int max, uint64_t time, int *value) {
+  return(filter_value(spec, state, min, max, time, value, 1));
+}
+
+int filter_flush(const FilterSpec *spec, FilterState *state, 
+                 int min, int max, int *value) {
+  if (! state->pending) return(0);
+  // the input hasn't moved since it was held, so use it again
+  *value = state->input;
+  return(filter_value(spec, state, min, max, state->deadline, value, 0));
+}
+
+void filter_get_stats(FilterStats *stats) {
+  stats->smoothed = __atomic_load_n(&smoothed_values, __ATOMIC_RELAXED);
+  stats->deadband = __atomic_load_n(&deadband_values, __ATOMIC_RELAXED);
+  stats->interval = __atomic_load_n(&interval_values, __ATOMIC_RELAXED);
+}
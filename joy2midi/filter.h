@@ -0,0 +1,68 @@
+#ifndef JOY2MIDI_FILTER_H
+#define JOY2MIDI_FILTER_H
+
+#include <stdint.h>
+
+// the default minimum cutoff frequency of smoothing in hertz
+#define FILTER_DEFAULT_CUTOFF 1.0
+// the default amount smoothing backs off as the input speeds up
+#define FILTER_DEFAULT_BETA 20
+// the milliseconds between steps of smoothing toward an input that has 
+//  stopped moving
+#define FILTER_SETTLE_STEP 10
+
+// settings for filtering a mapping's input values, which are all off at 0
+typedef struct {
+  // the cutoff frequency in hertz for a 1-euro filter when the input is 
+  //  still, or 0 for no smoothing
+  double cutoff;
+  // how fast the cutoff rises with the speed of the input, in hertz per 
+  //  input range per second
+  int beta;
+  // the distance in input units a value must move from the last one used 
+  //  before it's used
+  int deadband;
+  // the minimum time between values in milliseconds
+  int interval;
+} FilterSpec;
+
+// the state of a mapping's filters (reader thread only)
+typedef struct {
+  // whether any value has been used yet
+  int started;
+  // the time in microseconds of the last input and the last value used
+  uint64_t input_time;
+  uint64_t used_time;
+  // the smoothed position in the input range and its smoothed speed
+  double position;
+  double speed;
+  // the last value used
+  int value;
+  // the last input value, which is held back until the deadline in 
+  //  microseconds if pending is set
+  int input;
+  int pending;
+  uint64_t deadline;
+} FilterState;
+
+// counts of input values that filters kept from being used
+typedef struct {
+  uint32_t smoothed;
+  uint32_t deadband;
+  uint32_t interval;
+} FilterStats;
+
+// filter an input value in the range min to max at the given time in 
+//  microseconds, returning 0 if nothing should be sent for it or setting 
+//  the value to use and returning 1
+int filter_input(const FilterSpec *spec, FilterState *state, 
+                 int min, int max, uint64_t time, int *value);
+// send a held-back input at its deadline, either settling smoothing toward 
+//  it or sending it once a minimum interval is up, returning 0 if nothing 
+//  should be sent yet or setting the value to use and returning 1
+int filter_flush(const FilterSpec *spec, FilterState *state, 
+                 int min, int max, int *value);
+// get the counts of values suppressed by filters so far
+void filter_get_stats(FilterStats *stats);
+
+#endif
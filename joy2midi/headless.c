@@ -0,0 +1,114 @@
+#include "headless.h"
+#include "serialize.h"
+
+// the simulated frame clock
+static uint32_t now = 0;
+// the start of the next period to process
+static uint32_t period_start = 0;
+// the simulated sample rate and period size
+static uint32_t rate = 48000;
+static uint32_t period = 64;
+// where to write messages, or NULL to discard them
+static FILE *output_file = NULL;
+// whether to write messages as a raw MIDI byte stream instead of text
+static int raw_output = 0;
+// the names of the output ports, which are written with each message when 
+//  there's more than one
+static const char *const *ports = NULL;
+static MidiSerializer serializer;
+
+void headless_configure(uint32_t sample_rate, uint32_t period_size, 
+                        FILE *file, int raw) {
+  if (sample_rate > 0) rate = sample_rate;
+  if (period_size > 0) period = period_size;
+  output_file = file;
+  raw_output = raw;
+  serializer_init(&serializer);
+}
+
+// write a message as a line with its absolute frame, port if there are 
+//  several, and data bytes, with the context being the port's name
+static int file_write(void *context, int32_t time, 
+                      const uint8_t *data, size_t size) {
+  size_t i;
+  fprintf(output_file, "%u", period_start + time);
+  if (output_port_count() > 1) fprintf(output_file, " %s", (char *)context);
+  for (i = 0; i < size; i++) fprintf(output_file, " %02X", data[i]);
+  fprintf(output_file, "\n");
+  return(1);
+}
+
+// write a message to a raw byte stream
+static int raw_write(void *context, int32_t time, 
+                     const uint8_t *data, size_t size) {
+  uint8_t buffer[MIDI_EVENT_MAX];
+  uint32_t saved = serializer.saved;
+  size_t length = serializer_write(&serializer, data, size, buffer);
+  fwrite(buffer, 1, length, output_file);
+  output_count_bytes(length, serializer.saved - saved);
+  return(1);
+}
+
+// discard a message
+static int null_write(void *context, int32_t time, 
+                      const uint8_t *data, size_t size) {
+  return(1);
+}
+
+// process one period and move on to the next
+static void process_period(void) {
+  int port;
+  MidiSink sink = { (output_file == NULL) ? null_write : 
+                    (raw_output ? raw_write : file_write), NULL };
+  output_begin_period();
+  for (port = 0; port < output_port_count(); port++) {
+    sink.context = (void *)ports[port];
+    output_process(port, &sink, period_start, period);
+  }
+  output_end_period();
+  period_start += period;
+}
+
+void headless_advance(uint32_t frame) {
+  while ((int32_t)(frame - (period_start + period)) >= 0) process_period();
+  now = frame;
+}
+
+void headless_finish(void) {
+  // run a second past the last queued message so held controller 
+  //  messages come due too
+  uint32_t i;
+  while (output_pending() > 0) process_period();
+  for (i = 0; i < rate; i += period) process_period();
+  now = period_start;
+  if (output_file != NULL) fflush(output_file);
+}
+
+static int headless_start(const char *const *port_names, int port_count, 
+                          int coalesce_window) {
+  // start far enough in that the first period can look back a period
+  now = period_start = period;
+  ports = port_names;
+  output_init(port_count, coalesce_window, rate);
+  return(1);
+}
+
+static uint32_t headless_time(void) {
+  return(now);
+}
+
+static uint32_t headless_rate(void) {
+  return(rate);
+}
+
+static int headless_priority(void) {
+  return(0);
+}
+
+static void headless_stop(void) {
+  headless_finish();
+}
+
+OutputBackend headless_output = { 
+  headless_start, headless_time, headless_rate, headless_priority, 
+  headless_stop };
@@ -0,0 +1,24 @@
+#ifndef JOY2MIDI_HEADLESS_H
+#define JOY2MIDI_HEADLESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "output.h"
+
+// run output on a simulated clock instead of a sound server, so that 
+//  recorded input can be replayed as fast as possible
+extern OutputBackend headless_output;
+
+// set the simulated sample rate and period size, and the file to write 
+//  messages to, one line per message with its frame or as a raw MIDI byte 
+//  stream if raw is set, or NULL to discard them (call before starting)
+void headless_configure(uint32_t sample_rate, uint32_t period, FILE *file, 
+                        int raw);
+// move the simulated clock forward to a frame, processing each period 
+//  that ends on or before it
+void headless_advance(uint32_t frame);
+// process periods until everything queued has been sent
+void headless_finish(void);
+
+#endif
@@ -0,0 +1,76 @@
+#include <string.h>
+
+#include "histogram.h"
+
+// get the bucket a value falls in
+static int bucket_index(uint64_t value) {
+  if (value == 0) return(0);
+  int index = 64 - __builtin_clzll(value);
+  return((index < HISTOGRAM_BUCKETS) ? index : HISTOGRAM_BUCKETS - 1);
+}
+
+// get the smallest value that's too big for a bucket
+static uint64_t bucket_limit(int index) {
+  return(1ULL << index);
+}
+
+void histogram_init(Histogram *histogram) {
+  memset(histogram, 0, sizeof(Histogram));
+}
+
+void histogram_record(Histogram *histogram, uint64_t value) {
+  uint32_t *bucket = &histogram->counts[bucket_index(value)];
+  // there's only one writer, so plain increments can be published
+  __atomic_store_n(bucket, *bucket + 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&histogram->total, histogram->total + value, 
+    __ATOMIC_RELAXED);
+  if (value > histogram->max) 
+    __atomic_store_n(&histogram->max, value, __ATOMIC_RELAXED);
+  __atomic_store_n(&histogram->count, histogram->count + 1, __ATOMIC_RELAXED);
+}
+
+void histogram_read(const Histogram *histogram, Histogram *snapshot) {
+  int i;
+  snapshot->count = __atomic_load_n(&histogram->count, __ATOMIC_RELAXED);
+  snapshot->total = __atomic_load_n(&histogram->total, __ATOMIC_RELAXED);
+  snapshot->max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+  for (i = 0; i < HISTOGRAM_BUCKETS; i++) {
+    snapshot->counts[i] = 
+      __atomic_load_n(&histogram->counts[i], __ATOMIC_RELAXED);
+  }
+}
+
+uint64_t histogram_percentile(const Histogram *histogram, double fraction) {
+  int i;
+  uint64_t seen = 0, count = 0;
+  for (i = 0; i < HISTOGRAM_BUCKETS; i++) count += histogram->counts[i];
+  if (count == 0) return(0);
+  for (i = 0; i < HISTOGRAM_BUCKETS; i++) {
+    seen += histogram->counts[i];
+    if (seen >= fraction * count) break;
+  }
+  // the top bucket holds everything bigger too
+  if (i >= HISTOGRAM_BUCKETS - 1) return(histogram->max);
+  uint64_t limit = bucket_limit(i) - 1;
+  return((limit < histogram->max) ? limit : histogram->max);
+}
+
+void histogram_write_json(FILE *file, const Histogram *histogram) {
+  int i, first = 1;
+  fprintf(file, "{ \"count\": %llu, \"mean\": %.1f, \"max\": %llu, "
+    "\"p50\": %llu, \"p99\": %llu, \"p999\": %llu, \"buckets\": [", 
+    (unsigned long long)histogram->count, (histogram->count > 0) ? 
+      (double)histogram->total / histogram->count : 0.0, 
+    (unsigned long long)histogram->max, 
+    (unsigned long long)histogram_percentile(histogram, 0.5), 
+    (unsigned long long)histogram_percentile(histogram, 0.99), 
+    (unsigned long long)histogram_percentile(histogram, 0.999));
+  // list only the buckets with values in them, by the values they're below
+  for (i = 0; i < HISTOGRAM_BUCKETS; i++) {
+    if (histogram->counts[i] == 0) continue;
+    fprintf(file, "%s{ \"below\": %llu, \"count\": %u }", first ? " " : ", ", 
+      (unsigned long long)bucket_limit(i), histogram->counts[i]);
+    first = 0;
+  }
+  fprintf(file, "%s] }", first ? "" : " ");
+}
@@ -0,0 +1,35 @@
+#ifndef JOY2MIDI_HISTOGRAM_H
+#define JOY2MIDI_HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// the number of buckets in a histogram, where bucket 0 counts zeros and 
+//  each bucket after that counts values below the next power of two
+#define HISTOGRAM_BUCKETS 40
+
+// a distribution of values with exactly one writer thread, which any 
+//  thread can read without locking
+typedef struct {
+  uint32_t counts[HISTOGRAM_BUCKETS];
+  // the number of values recorded
+  uint64_t count;
+  // the sum and largest of the values recorded
+  uint64_t total;
+  uint64_t max;
+} Histogram;
+
+// reset a histogram to empty (not thread-safe)
+void histogram_init(Histogram *histogram);
+// add a value to a histogram from its writer thread, which never blocks 
+//  and takes constant time
+void histogram_record(Histogram *histogram, uint64_t value);
+// take a snapshot of a histogram from any thread
+void histogram_read(const Histogram *histogram, Histogram *snapshot);
+// get an upper bound for the value below which the given fraction of the 
+//  recorded values fall
+uint64_t histogram_percentile(const Histogram *histogram, double fraction);
+// write a histogram as a JSON object
+void histogram_write_json(FILE *file, const Histogram *histogram);
+
+#endif
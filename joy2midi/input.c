@@ -0,0 +1,384 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+
+#include "evdev.h"
+#include "input.h"
+
+// the most events to handle from one wait
+#define INPUT_MAX_WAIT_EVENTS 16
+// the most directories to watch for devices being plugged in
+#define MAX_WATCHES (MAX_DEVICE_PATHS + 1)
+
+// the amount of output to send to the console
+extern int verbosity;
+
+// a counter only written by the reader thread
+static uint32_t collapsed_events = 0;
+// the epoll instance all inputs are waited on with
+static int epoll_fd = -1;
+// the inotify instance for watching devices come and go
+static int inotify_fd = -1;
+// the callbacks to dispatch to
+static InputHandlers *input_handlers = NULL;
+// the device paths requested, or none to use all joysticks
+static char device_paths[MAX_DEVICE_PATHS][PATH_MAX];
+static int device_path_count = 0;
+// devices that are currently open
+static InputDevice devices[MAX_DEVICES];
+// state for the devices that are read through evdev
+static EvdevState evdev_states[MAX_DEVICES];
+
+// determine whether a path is for an evdev device
+static int is_evdev(const char *path) {
+  const char *name = strrchr(path, '/');
+  name = (name != NULL) ? name + 1 : path;
+  return(strncmp(name, "event", 5) == 0);
+}
+
+// determine whether a path is one we should open
+static int is_wanted(const char *path) {
+  int i;
+  if (device_path_count == 0) {
+    const char *prefix = INPUT_DIRECTORY "/js";
+    return(strncmp(path, prefix, strlen(prefix)) == 0);
+  }
+  for (i = 0; i < device_path_count; i++) {
+    if (strcmp(device_paths[i], path) == 0) return(1);
+  }
+  return(0);
+}
+
+// find the open device with the given path
+static InputDevice *find_device(const char *path) {
+  int i;
+  for (i = 0; i < MAX_DEVICES; i++) {
+    if ((devices[i].fd >= 0) && (strcmp(devices[i].path, path) == 0)) 
+      return(&devices[i]);
+  }
+  return(NULL);
+}
+
+// open a device if it isn't already open
+static void open_device(const char *path) {
+  int i;
+  if (find_device(path) != NULL) return;
+  InputDevice *device = NULL;
+  for (i = 0; i < MAX_DEVICES; i++) {
+    if (devices[i].fd < 0) {
+      device = &devices[i];
+      break;
+    }
+  }
+  if (device == NULL) {
+    fprintf(stderr, "ERROR: Too many devices to open '%s'.\n", path);
+    return;
+  }
+  // devices may not be readable yet when they first appear, which is fine 
+  //  because we'll hear about it again when their permissions change
+  int fd = open(path, O_RDONLY | O_NONBLOCK);
+  if (fd < 0) {
+    if (verbosity >= 1) {
+      fprintf(stderr, "WARNING: Failed to open device at '%s' for reading.\n", 
+        path);
+    }
+    return;
+  }
+  device->fd = fd;
+  strncpy(device->path, path, sizeof(device->path) - 1);
+  device->path[sizeof(device->path) - 1] = '\0';
+  int name_result;
+  if (is_evdev(path)) {
+    // stamp events on the same clock no matter how the system clock changes
+    int clock = CLOCK_MONOTONIC;
+    ioctl(fd, EVIOCSCLOCKID, &clock);
+    device->clock = INPUT_CLOCK_EVDEV;
+    device->evdev = &evdev_states[device - devices];
+    evdev_init(device->evdev, fd);
+    name_result = ioctl(fd, EVIOCGNAME(sizeof(device->name)), device->name);
+  }
+  else {
+    device->clock = INPUT_CLOCK_JOYSTICK;
+    device->evdev = NULL;
+    name_result = ioctl(fd, JSIOCGNAME(sizeof(device->name)), device->name);
+  }
+  if (name_result < 0) {
+    strncpy(device->name, path, sizeof(device->name) - 1);
+  }
+  device->name[sizeof(device->name) - 1] = '\0';
+  device->section = 0;
+  device->section_generation = 0;
+  struct epoll_event ready;
+  memset(&ready, 0, sizeof(ready));
+  ready.events = EPOLLIN;
+  ready.data.ptr = device;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ready) < 0) {
+    fprintf(stderr, "ERROR: Failed to watch device at '%s'.\n", path);
+    close(fd);
+    device->fd = -1;
+    return;
+  }
+  if (verbosity >= 1) printf("Opened '%s' (%s)\n", device->path, device->name);
+  if (input_handlers->opened != NULL) input_handlers->opened(device);
+}
+
+// close a device that was unplugged or failed
+static void close_device(InputDevice *device) {
+  if (device->fd < 0) return;
+  if (input_handlers->closed != NULL) input_handlers->closed(device);
+  epoll_ctl(epoll_fd, EPOLL_CTL_DEL, device->fd, NULL);
+  close(device->fd);
+  device->fd = -1;
+  if (verbosity >= 1) printf("Closed '%s'\n", device->path);
+}
+
+// open all wanted devices in a directory
+static void scan_directory(const char *directory) {
+  char path[PATH_MAX];
+  struct dirent *entry;
+  DIR *dir = opendir(directory);
+  if (dir == NULL) return;
+  while ((entry = readdir(dir)) != NULL) {
+    if (snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name) 
+          >= sizeof(path)) continue;
+    if (is_wanted(path)) open_device(path);
+  }
+  closedir(dir);
+}
+
+// the directories being watched for devices coming and going
+static char watched_directories[MAX_WATCHES][PATH_MAX];
+static int watched_descriptors[MAX_WATCHES];
+static int watch_count = 0;
+
+// add a directory to the watch list if it isn't already there
+static void add_watch(const char *directory) {
+  int i;
+  for (i = 0; i < watch_count; i++) {
+    if (strcmp(watched_directories[i], directory) == 0) return;
+  }
+  if (watch_count >= MAX_WATCHES) return;
+  int wd = inotify_add_watch(inotify_fd, directory, 
+    IN_CREATE | IN_ATTRIB | IN_DELETE);
+  if (wd < 0) {
+    if (verbosity >= 1) {
+      fprintf(stderr, "WARNING: Failed to watch '%s' for devices.\n", 
+        directory);
+    }
+    return;
+  }
+  strncpy(watched_directories[watch_count], directory, PATH_MAX - 1);
+  watched_directories[watch_count][PATH_MAX - 1] = '\0';
+  watched_descriptors[watch_count] = wd;
+  watch_count++;
+}
+
+// split a path into the directory to watch and the full path that 
+//  notifications from that directory will produce
+static int normalize_path(const char *path, char *directory, char *full) {
+  char copy[PATH_MAX];
+  strncpy(copy, path, sizeof(copy) - 1);
+  copy[sizeof(copy) - 1] = '\0';
+  strcpy(directory, dirname(copy));
+  strncpy(copy, path, sizeof(copy) - 1);
+  return(snprintf(full, PATH_MAX, "%s/%s", directory, basename(copy)) 
+    < PATH_MAX);
+}
+
+// handle notifications about devices coming and going
+static void read_notifications(void) {
+  int i;
+  char path[PATH_MAX];
+  char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  ssize_t length;
+  while ((length = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+    char *p;
+    for (p = buffer; p < buffer + length; 
+         p += sizeof(struct inotify_event) + ((struct inotify_event *)p)->len) {
+      struct inotify_event *notice = (struct inotify_event *)p;
+      if (notice->len == 0) continue;
+      // find which directory the notice came from
+      const char *directory = NULL;
+      for (i = 0; i < watch_count; i++) {
+        if (watched_descriptors[i] == notice->wd) 
+          directory = watched_directories[i];
+      }
+      if (directory == NULL) continue;
+      if (snprintf(path, sizeof(path), "%s/%s", directory, notice->name) 
+            >= sizeof(path)) continue;
+      if (! is_wanted(path)) continue;
+      if (notice->mask & IN_DELETE) {
+        InputDevice *device = find_device(path);
+        if (device != NULL) close_device(device);
+      }
+      else {
+        open_device(path);
+      }
+    }
+  }
+}
+
+int input_collapse(JoystickEvent *events, int count) {
+  int i, kept = count;
+  uint8_t seen[256];
+  memset(seen, 0, sizeof(seen));
+  // mark superseded events from the end so the latest value of each axis 
+  //  stays in its place
+  for (i = count - 1; i >= 0; i--) {
+    if (events[i].type != JS_EVENT_AXIS) continue;
+    if (seen[events[i].number]) {
+      events[i].type = 0;
+      kept--;
+    }
+    seen[events[i].number] = 1;
+  }
+  if (kept == count) return(count);
+  __atomic_store_n(&collapsed_events, collapsed_events + (count - kept), 
+    __ATOMIC_RELAXED);
+  // close up the gaps
+  kept = 0;
+  for (i = 0; i < count; i++) {
+    if (events[i].type != 0) events[kept++] = events[i];
+  }
+  return(kept);
+}
+
+uint32_t input_collapsed(void) {
+  return(__atomic_load_n(&collapsed_events, __ATOMIC_RELAXED));
+}
+
+int input_convert(const struct js_event *raw, JoystickEvent *events, 
+                  int count) {
+  int i;
+  for (i = 0; i < count; i++) {
+    events[i].time = (uint64_t)raw[i].time * 1000;
+    events[i].value = raw[i].value;
+    events[i].type = raw[i].type;
+    events[i].number = raw[i].number;
+  }
+  return(count);
+}
+
+// pass a complete evdev frame on to the handlers
+static void dispatch_frame(void *context, JoystickEvent *events, int count) {
+  InputDevice *device = (InputDevice *)context;
+  int kept = input_collapse(events, count);
+  input_handlers->events(device, events, kept);
+}
+
+// read a batch of events from an evdev device that's ready, returning the 
+//  result of the read
+static ssize_t read_evdev(InputDevice *device) {
+  struct input_event raw[EVDEV_BATCH_SIZE];
+  ssize_t length = read(device->fd, raw, sizeof(raw));
+  if (length >= (ssize_t)sizeof(struct input_event)) {
+    evdev_decode(device->evdev, raw, length / sizeof(struct input_event), 
+      dispatch_frame, device);
+  }
+  return(length);
+}
+
+// read a batch of events from a joystick API device that's ready, 
+//  returning the result of the read
+static ssize_t read_joystick(InputDevice *device) {
+  struct js_event raw[INPUT_BATCH_SIZE];
+  JoystickEvent events[INPUT_BATCH_SIZE];
+  ssize_t length = read(device->fd, raw, sizeof(raw));
+  if (length >= (ssize_t)sizeof(struct js_event)) {
+    int count = input_convert(raw, events, length / sizeof(struct js_event));
+    int kept = input_collapse(events, count);
+    input_handlers->events(device, events, kept);
+  }
+  return(length);
+}
+
+// read a batch of events from a device that's ready
+static void read_device(InputDevice *device) {
+  ssize_t length = (device->evdev != NULL) ? 
+    read_evdev(device) : read_joystick(device);
+  if (length > 0) {
+    return;
+  }
+  else if ((length < 0) && ((errno == EAGAIN) || (errno == EINTR))) {
+    return;
+  }
+  // anything else means the device went away
+  else {
+    close_device(device);
+  }
+}
+
+int input_init(char **paths, int path_count, InputHandlers *handlers) {
+  int i;
+  char directory[PATH_MAX];
+  input_handlers = handlers;
+  for (i = 0; i < MAX_DEVICES; i++) devices[i].fd = -1;
+  if (path_count > MAX_DEVICE_PATHS) {
+    fprintf(stderr, "ERROR: Too many devices (the limit is %d).\n", 
+      MAX_DEVICE_PATHS);
+    return(0);
+  }
+  device_path_count = path_count;
+  epoll_fd = epoll_create1(0);
+  inotify_fd = inotify_init1(IN_NONBLOCK);
+  if ((epoll_fd < 0) || (inotify_fd < 0)) {
+    fprintf(stderr, "ERROR: Failed to set up device monitoring.\n");
+    return(0);
+  }
+  struct epoll_event ready;
+  memset(&ready, 0, sizeof(ready));
+  ready.events = EPOLLIN;
+  ready.data.ptr = NULL;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, inotify_fd, &ready) < 0) {
+    fprintf(stderr, "ERROR: Failed to set up device monitoring.\n");
+    return(0);
+  }
+  // watch for devices where they'll appear
+  if (path_count == 0) {
+    add_watch(INPUT_DIRECTORY);
+  }
+  for (i = 0; i < path_count; i++) {
+    if (! normalize_path(paths[i], directory, device_paths[i])) {
+      fprintf(stderr, "ERROR: The device path '%s' is too long.\n", paths[i]);
+      return(0);
+    }
+    add_watch(directory);
+  }
+  // open devices that are already present
+  if (path_count == 0) scan_directory(INPUT_DIRECTORY);
+  for (i = 0; i < path_count; i++) {
+    if (access(device_paths[i], F_OK) == 0) open_device(device_paths[i]);
+    else if (verbosity >= 1) {
+      printf("Waiting for '%s' to be plugged in\n", paths[i]);
+    }
+  }
+  return(1);
+}
+
+int input_poll(int timeout) {
+  int i, count;
+  struct epoll_event ready[INPUT_MAX_WAIT_EVENTS];
+  count = epoll_wait(epoll_fd, ready, INPUT_MAX_WAIT_EVENTS, timeout);
+  if (count < 0) return(errno == EINTR);
+  for (i = 0; i < count; i++) {
+    if (ready[i].data.ptr == NULL) {
+      read_notifications();
+    }
+    else {
+      InputDevice *device = (InputDevice *)ready[i].data.ptr;
+      if (device->fd < 0) continue;
+      if (ready[i].events & EPOLLIN) read_device(device);
+      else if (ready[i].events & (EPOLLHUP | EPOLLERR)) close_device(device);
+    }
+  }
+  return(1);
+}
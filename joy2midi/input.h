@@ -0,0 +1,98 @@
+#ifndef JOY2MIDI_INPUT_H
+#define JOY2MIDI_INPUT_H
+
+#include <limits.h>
+#include <stdint.h>
+
+#include <linux/joystick.h>
+
+#include "debounce.h"
+#include "filter.h"
+#include "mapping.h"
+
+// the most devices that can be open at once
+#define MAX_DEVICES 16
+// the most device paths that can be requested on the command line
+#define MAX_DEVICE_PATHS 16
+// the most events to read from a device at once (a page of events)
+#define INPUT_BATCH_SIZE (4096 / sizeof(struct js_event))
+// the clocks that device timestamps can come from, which have to be 
+//  correlated with the output clock separately
+#define INPUT_CLOCK_JOYSTICK 0
+#define INPUT_CLOCK_EVDEV 1
+#define INPUT_CLOCKS 2
+// the directory joystick devices appear in
+#define INPUT_DIRECTORY "/dev/input"
+
+// an event from a joystick in the form the joystick API uses, but with 
+//  the time in microseconds so that evdev's finer timestamps survive
+typedef struct {
+  // when the event happened on the device's clock
+  uint64_t time;
+  // the position of an axis from -32767 to 32767, or 1 for a pressed button
+  int16_t value;
+  // JS_EVENT_BUTTON or JS_EVENT_AXIS
+  uint8_t type;
+  // the number of the button or axis
+  uint8_t number;
+} JoystickEvent;
+
+// translation state for devices using the evdev interface (see evdev.h)
+struct EvdevState;
+
+// an open joystick device
+typedef struct {
+  // the file descriptor of the open device, or -1 if the slot is free
+  int fd;
+  // the path the device was opened from
+  char path[PATH_MAX];
+  // the name the driver reports for the device
+  char name[128];
+  // the clock the device stamps events with (INPUT_CLOCK_...)
+  int clock;
+  // state for reading evdev devices, or NULL for joystick API devices
+  struct EvdevState *evdev;
+  // the index of the map section used for the device
+  int section;
+  // identifies the set of sections the index refers to
+  int section_generation;
+  // the state of debouncing the device's buttons (reader thread only)
+  DebounceState debounce;
+  // the state of the filters on each mapping with filters, and what each 
+  //  mapping was, for the same set of sections as the section index 
+  //  (reader thread only)
+  FilterState *filters;
+  MappingKey *filter_keys;
+  int filter_count;
+} InputDevice;
+
+// callbacks for things that happen to input devices
+typedef struct {
+  // called after a device is opened
+  void (*opened)(InputDevice *device);
+  // called before a device is closed
+  void (*closed)(InputDevice *device);
+  // called with each batch of events read from a device
+  void (*events)(InputDevice *device, JoystickEvent *events, int count);
+} InputHandlers;
+
+// start watching for devices, opening the given paths if there are any 
+//  and all joystick devices otherwise, with paths to event devices 
+//  (/dev/input/event<N>) read through evdev, and reopening them whenever they 
+//  are plugged back in; returns 0 on failure
+int input_init(char **paths, int path_count, InputHandlers *handlers);
+// wait up to timeout milliseconds for input and dispatch it to the 
+//  handlers, returning 0 on failure
+int input_poll(int timeout);
+// drop axis events that are followed by another event for the same axis 
+//  in a batch, since only the latest value matters, and return the 
+//  number of events left (reader thread only)
+int input_collapse(JoystickEvent *events, int count);
+// get the number of axis events dropped so far because a later event in 
+//  the same batch superseded them
+uint32_t input_collapsed(void);
+// convert events read from the joystick API, returning how many there are
+int input_convert(const struct js_event *raw, JoystickEvent *events, 
+                  int count);
+
+#endif
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <jack/jack.h>
+#include <jack/midiport.h>
+
+#include "jack_output.h"
+
+// the JACK client we're connected as
+static jack_client_t *jack_client = NULL;
+// the JACK output ports for MIDI
+static jack_port_t *jack_ports[OUTPUT_MAX_PORTS];
+static int jack_port_count = 0;
+
+// write a message to a JACK port buffer, which can fill up
+static int jack_write(void *port_buffer, int32_t time, 
+                      const uint8_t *data, size_t size) {
+  unsigned char *midi_buffer = 
+    jack_midi_event_reserve(port_buffer, time, size);
+  if (midi_buffer == NULL) return(0);
+  memcpy(midi_buffer, data, size);
+  return(1);
+}
+
+static int jack_process(jack_nframes_t nframes, void *context) {
+  int i;
+  uint32_t period_start = jack_last_frame_time(jack_client);
+  output_begin_period();
+  for (i = 0; i < jack_port_count; i++) {
+    // get a writable buffer for the port and clear it for writing
+    void *port_buffer = jack_port_get_buffer(jack_ports[i], nframes);
+    if (port_buffer == NULL) continue;
+    jack_midi_clear_buffer(port_buffer);
+    MidiSink sink = { jack_write, port_buffer };
+    output_process(i, &sink, period_start, nframes);
+  }
+  output_end_period();
+  return(0);
+}
+
+static int jack_start(const char *const *port_names, int port_count, 
+                      int coalesce_window) {
+  int i, result;
+  // connect to JACK
+  jack_status_t jack_status;
+  jack_client = jack_client_open("joy2midi", JackNoStartServer, &jack_status);
+  if ((jack_status & JackServerFailed) != 0) { fprintf(stderr, 
+    "ERROR: Failed to connect to the JACK server.\n");
+    return(0);
+  }
+  else if ((jack_status & JackServerError) != 0) { fprintf(stderr, 
+    "ERROR: Failed to communicate with the JACK server.\n");
+    return(0);
+  }
+  else if ((jack_status & JackFailure) != 0) { fprintf(stderr, 
+    "ERROR: Failed to create a JACK client.\n");
+    return(0);
+  }
+  // create ports for MIDI output
+  for (i = 0; i < port_count; i++) {
+    jack_ports[i] = jack_port_register(jack_client, port_names[i], 
+      JACK_DEFAULT_MIDI_TYPE, JackPortIsOutput | JackPortIsTerminal, 0);
+    if (jack_ports[i] == NULL) { fprintf(stderr, 
+      "ERROR: Failed to create the JACK output port '%s'.\n", port_names[i]);
+      return(0);
+    }
+  }
+  jack_port_count = port_count;
+  // set up the queues now that we know the sample rate
+  output_init(port_count, coalesce_window, jack_get_sample_rate(jack_client));
+  // activate the client for sending MIDI
+  result = jack_set_process_callback(jack_client, jack_process, NULL);
+  if (result != 0) { fprintf(stderr, 
+    "ERROR: Failed to bind a JACK processing callback (error %i).\n", result);
+    return(0);
+  }
+  result = jack_activate(jack_client);
+  if (result != 0) { fprintf(stderr, 
+    "ERROR: Failed to activate JACK client (error %i).\n", result);
+    return(0);
+  }
+  return(1);
+}
+
+static uint32_t jack_time(void) {
+  return(jack_frame_time(jack_client));
+}
+
+static uint32_t jack_rate(void) {
+  return(jack_get_sample_rate(jack_client));
+}
+
+static int jack_priority(void) {
+  int priority = jack_client_real_time_priority(jack_client);
+  return((priority > 0) ? priority : 0);
+}
+
+static void jack_stop(void) {
+  if (jack_client != NULL) jack_client_close(jack_client);
+  jack_client = NULL;
+}
+
+OutputBackend jack_output = { 
+  jack_start, jack_time, jack_rate, jack_priority, jack_stop };
@@ -0,0 +1,9 @@
+#ifndef JOY2MIDI_JACK_OUTPUT_H
+#define JOY2MIDI_JACK_OUTPUT_H
+
+#include "output.h"
+
+// send MIDI to a JACK output port
+extern OutputBackend jack_output;
+
+#endif
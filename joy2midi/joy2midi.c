@@ -1,168 +1,641 @@
 #include <ctype.h>
 #include <fcntl.h>
+#include <getopt.h>
 #include <malloc.h>
 #include <math.h>
+#include <poll.h>
 #include <pthread.h>
+#include <signal.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include <libgen.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
 
-#include <linux/joystick.h>
+#include "bench.h"
+#include "capture.h"
+#include "debounce.h"
+#include "headless.h"
+#include "input.h"
+#ifdef HAVE_JACK
+#include "jack_output.h"
+#endif
+#include "mapping.h"
+#include "midistate.h"
+#include "osc_output.h"
+#include "output.h"
+#include "realtime.h"
+#include "replay.h"
+#include "serial_output.h"
+#include "stats.h"
+#include "timebase.h"
 
-#include <jack/jack.h>
-#include <jack/midiport.h>
-
-// the path and file to read mapping configuration from
+// the path to read mapping configuration from, and its text while it's 
+//  being parsed
 char *map_path = NULL;
-FILE *map_file = NULL;
-// the file to read joystick events from
-char *device_path = NULL;
-int device_file = 0;
-// the amount of output to send to the console
+const char *map_text = NULL;
+size_t map_length = 0;
+// the amount of output to send to the console (from the active config)
 int verbosity = 0;
-// the minimum number of milliseconds between events on a button
-int debounce = 0;
-// the channel to send MIDI messages on
-int channel = 0;
-
-// the JACK client we're connected as
-jack_client_t *jack_client = NULL;
-// the JACK output port for MIDI
-jack_port_t *jack_port = NULL;
-// a mutex for stopping joystick input during the process call
-pthread_mutex_t process_lock;
-// the sample rate JACK is using
-jack_nframes_t jack_sample_rate;
-
-// a struct for input/output mapping specifiers
-typedef struct {
-  int type;
-  int number;
-  int min;
-  int max;
-} MapSpec;
-// an entry in a linked list of mappings
+
+// everything read from a map file
 typedef struct {
-  MapSpec inspec;
-  MapSpec outspec;
-  void *next;
-} Mapping;
-// the ends of the linked list of mappings
-Mapping *map_head = NULL;
-Mapping *map_tail = NULL;
-
-// a struct to store events from the joystick
-typedef struct js_event JoystickEvent;
+  // the amount of output to send to the console
+  int verbosity;
+  // how long to ignore chatter from buttons after they change
+  DebounceSpec debounce;
+  // the channel to send MIDI messages on, unless a mapping gives another
+  int channel;
+  // the names of the output ports, starting with the default one
+  char *ports[OUTPUT_MAX_PORTS];
+  int port_count;
+  // whether to precompute transforms into lookup tables
+  int use_tables;
+  // the window in milliseconds to coalesce controller messages over, with 
+  //  0 meaning one output period and a negative number turning it off
+  int coalesce_window;
+  // groups of mappings for different devices, with the first being for 
+  //  devices no other section matches
+  MapSection sections[MAX_SECTIONS];
+  int section_count;
+  // the section mappings are being added to while parsing
+  int current_section;
+  // the number of mappings in all sections
+  int mapping_count;
+  // the mappings with filters, in the order of their filter states on each 
+  //  device
+  Mapping **filtered;
+  int filtered_count;
+  // a number that's different for each config loaded
+  int generation;
+} Config;
+// the config in use, which is replaced when the map file changes and never 
+//  written once it's published, so anything that changes per device or per 
+//  event lives on the device instead
+Config *config = NULL;
+// the config the reader thread is currently using, if any
+Config *config_in_use = NULL;
+// the config being filled in by the parser
+Config *loading_config = NULL;
+// the number of errors found while parsing the map file
+int parse_errors = 0;
+
+// where MIDI messages go
+OutputBackend *output = NULL;
+// estimates of how the times of events from each kind of device correspond 
+//  to output frame times
+Timebase input_timebases[INPUT_CLOCKS];
+// the devices that are open, so their held-back button releases can be 
+//  sent when they come due (reader thread only)
+InputDevice *open_devices[MAX_DEVICES];
+// the seconds between printing statistics when verbose
+#define STATS_INTERVAL 10
+// a file to write statistics to as JSON, or NULL to write them to stdout 
+//  only when asked with SIGUSR1
+char *stats_path = NULL;
+// the seconds between writing statistics to the file
+int stats_interval = STATS_INTERVAL;
+// a Standard MIDI File to capture sent messages to, or NULL
+char *capture_path = NULL;
+
 // a struct to store outgoing MIDI events
 typedef struct {
-  // the time of the event within the frame in microseconds
-  long time;
-  // event data
-  uint8_t data[3];
-  // a pointer to construct a linked list
-  void *next;
+  // the estimated output frame time when the input event happened
+  uint32_t time;
+  // the number of valid bytes in data
+  uint8_t size;
+  // the kind of message group (MIDI_GROUP_...)
+  uint8_t group;
+  // the output port to send the message on
+  uint8_t port;
+  // event data, as one or more complete messages
+  uint8_t data[MIDI_EVENT_MAX];
 } MidiMessage;
-// the ends of the linked list of messages
-MidiMessage *messages_head = NULL;
-MidiMessage *messages_tail = NULL;
+// what the reader thread has sent on each channel of each port
+MidiState sent_state[OUTPUT_MAX_PORTS];
+// the names of the output ports, which stay the same while running
+const char *output_ports[OUTPUT_MAX_PORTS];
 
 // forward declarations for the main program functions
-void add_mapping(MapSpec, MapSpec);
-MidiMessage *joystick_event_to_midi_message(JoystickEvent);
-void send_midi_message(MidiMessage *message);
-static int jack_process(jack_nframes_t, void *);
+void add_mapping(MapSpec, MapSpec, MapOptions);
+void begin_section(char *);
+void declare_port(char *);
+int find_port(char *);
+int same_ports(Config *);
+Config *load_config(int strict);
+void free_config(Config *);
+void handled_signals(sigset_t *);
+void *reload_thread(void *);
+void write_stats(void);
+void device_opened(InputDevice *);
+void device_closed(InputDevice *);
+void resolve_filters(Config *, InputDevice *);
+void send_releases(Config *, InputDevice *, uint64_t);
+void device_events(InputDevice *, JoystickEvent *, int);
+int joystick_event_to_midi_messages(Config *, InputDevice *, JoystickEvent, 
+                                    MidiMessage *);
+int mapping_message(Config *, Mapping *, int, uint32_t, MidiMessage *);
+void send_midi_messages(MidiMessage *messages, int count);
+int next_held(Config *, uint64_t *);
+int device_next_held(Config *, InputDevice *, uint64_t *);
+void send_held(Config *, InputDevice *, uint64_t);
+int wait_until(int, uint64_t, uint32_t, uint32_t);
+int held_timeout(int);
+void send_due_held(void);
+void print_stats(void);
+int run_bench(const char *replay_path, int replay_evdev);
+void print_cost(const char *stage, BenchCost cost, const char *unit);
+BenchCost bench_parse(void);
+void replay_clock(uint64_t time);
 
 // map file parser (generated by Bison)
 #include "parser.tab.c"
 
 int main(int argc, char **argv) {
-  int result;
-  // the most recent joystick event received from the device
-  JoystickEvent event;
-  // the next message to send to MIDI output
-  MidiMessage *message = NULL;
+  int option;
+  // options for running without a sound server or devices
+  char *replay_path = NULL;
+  char *output_path = NULL;
+  int replay_evdev = 0;
+  int discard = 0;
+  int raw = 0;
+  char *serial_path = NULL;
+  char *osc_target = NULL;
+  int bench = 0;
+  long rate = 0;
+  long period = 0;
+  // options for running the reader in real time
+  int lock = 0;
+  int priority = 0;
+  int cpu = -1;
+  static struct option options[] = {
+    { "replay", required_argument, NULL, 'r' },
+    { "evdev",  no_argument,       NULL, 'e' },
+    { "output", required_argument, NULL, 'o' },
+    { "null",   no_argument,       NULL, 'n' },
+    { "raw",    no_argument,       NULL, 'w' },
+    { "serial", required_argument, NULL, 's' },
+    { "osc",    required_argument, NULL, 'O' },
+    { "bench",  no_argument,       NULL, 'b' },
+    { "rate",   required_argument, NULL, 'R' },
+    { "period", required_argument, NULL, 'P' },
+    { "stats",  required_argument, NULL, 'S' },
+    { "stats-interval", required_argument, NULL, 'I' },
+    { "lock",   no_argument,       NULL, 'L' },
+    { "priority", required_argument, NULL, 'p' },
+    { "cpu",    required_argument, NULL, 'c' },
+    { "capture", required_argument, NULL, 'C' },
+    { NULL, 0, NULL, 0 }
+  };
+  // the callbacks for device input
+  InputHandlers handlers = { device_opened, device_closed, device_events };
   
   // check arguments
-  if (argc != 3) {
+  while ((option = getopt_long(argc, argv, "", options, NULL)) != -1) {
+    switch (option) {
+      case 'r': replay_path = optarg; break;
+      case 'e': replay_evdev = 1; break;
+      case 'o': output_path = optarg; break;
+      case 'n': discard = 1; break;
+      case 'w': raw = 1; break;
+      case 's': serial_path = optarg; break;
+      case 'O': osc_target = optarg; break;
+      case 'b': bench = 1; break;
+      case 'R': rate = strtol(optarg, NULL, 10); break;
+      case 'P': period = strtol(optarg, NULL, 10); break;
+      case 'S': stats_path = optarg; break;
+      case 'I': stats_interval = strtol(optarg, NULL, 10); break;
+      case 'L': lock = 1; break;
+      case 'p': priority = strtol(optarg, NULL, 10); break;
+      case 'c': cpu = strtol(optarg, NULL, 10); break;
+      case 'C': capture_path = optarg; break;
+      default: return(1);
+    }
+  }
+  if (optind >= argc) {
     printf("\n"
-    "Usage: joy2midi <map-file> <device>\n"
+    "Usage: joy2midi [options] <map-file> [<device> ...]\n"
+    "\n"
+    "  With no devices, all joysticks are used as they're plugged in.\n"
+    "\n"
+    "Options:\n"
+    "  --replay <file>  Read events recorded from a joystick device instead\n"
+    "                   of live devices, and write MIDI without JACK.\n"
+    "  --evdev          The replayed events were recorded from an evdev\n"
+    "                   device (/dev/input/event<N>).\n"
+    "  --output <file>  Write replayed MIDI to a file, one message per line\n"
+    "                   with its frame time (the default is stdout).\n"
+    "  --null           Discard replayed MIDI.\n"
+    "  --raw            Write replayed MIDI as a raw byte stream.\n"
+    "  --serial <path>  Send MIDI to a serial port or raw MIDI device\n"
+    "                   (like /dev/ttyUSB0 or /dev/snd/midiC1D0) instead\n"
+    "                   of JACK.\n"
+    "  --osc <host:port>\n"
+    "                   Send OSC bundles over UDP instead of JACK MIDI.\n"
+    "  --bench          Measure how fast events are translated with the\n"
+    "                   map file, using replayed or synthesized events.\n"
+    "  --rate <n>       Sample rate to simulate without JACK (48000).\n"
+    "  --period <n>     Period size in frames to simulate without JACK (64).\n"
+    "  --stats <file>   Write latency and throughput statistics to a file\n"
+    "                   as JSON every so often and on SIGUSR1 (without\n"
+    "                   this, SIGUSR1 writes them to stdout).\n"
+    "  --stats-interval <s>\n"
+    "                   Seconds between writing statistics (10).\n"
+    "  --lock           Lock all memory into RAM and touch it up front so\n"
+    "                   nothing faults in while running.\n"
+    "  --priority <n>   Read input with real-time (SCHED_FIFO) priority,\n"
+    "                   which is kept below JACK's.\n"
+    "  --cpu <n>        Read input on only the given CPU.\n"
+    "  --capture <file> Record the MIDI that's sent to a Standard MIDI File.\n"
     "\n");
     return(1);
   }
-  
-  // open and parse the map file
-  map_path = argv[argc - 2];
-  map_file = fopen(map_path, "rb");
-  if (map_file == NULL) { fprintf(stderr, 
-    "ERROR: Failed to open map file at '%s' for reading.\n", map_path);
+  if ((rate < 0) || (period < 0)) {
+    fprintf(stderr, "ERROR: The rate and period must be positive.\n");
     return(1);
   }
-  parse_map();
-  fclose(map_file);
-  
-  // open the device file
-  device_path = argv[argc - 1];
-  device_file = open(device_path, O_RDONLY);
-  if (! device_file) { fprintf(stderr, 
-    "ERROR: Failed to open device at '%s' for reading.\n", device_path);
+  if (stats_interval <= 0) {
+    fprintf(stderr, "ERROR: The statistics interval must be positive.\n");
     return(1);
   }
+  int headless = ((replay_path != NULL) || (bench));
   
-  // connect to JACK
-  jack_status_t jack_status;
-  jack_client = jack_client_open("joy2midi", JackNoStartServer, &jack_status);
-  if ((jack_status & JackServerFailed) != 0) { fprintf(stderr, 
-    "ERROR: Failed to connect to the JACK server.\n");
-    return(1);
+  // handle reload, statistics and capture signals in the reload thread 
+  //  only, which has to be set up before any other threads start so they 
+  //  inherit it
+  sigset_t reload_signals;
+  handled_signals(&reload_signals);
+  pthread_sigmask(SIG_BLOCK, &reload_signals, NULL);
+  
+  // load the map file
+  map_path = argv[optind];
+  config = load_config(0);
+  if (config == NULL) return(1);
+  verbosity = config->verbosity;
+  
+  for (option = 0; option < OUTPUT_MAX_PORTS; option++) {
+    midi_state_init(&sent_state[option]);
   }
-  else if ((jack_status & JackServerError) != 0) { fprintf(stderr, 
-    "ERROR: Failed to communicate with the JACK server.\n");
-    return(1);
+  // keep memory resident so translating an event never waits on a page 
+  //  fault, where locking maps in everything that exists so far
+  if ((lock) && (realtime_lock_memory())) {
+    if (verbosity >= 1) printf("Locked memory\n");
   }
-  else if ((jack_status & JackFailure) != 0) { fprintf(stderr, 
-    "ERROR: Failed to create a JACK client.\n");
-    return(1);
+  
+  // choose where to send MIDI
+  if (headless) {
+    // benchmarks discard output to measure translation on its own
+    FILE *file = NULL;
+    if ((bench) || (discard)) file = NULL;
+    else if ((output_path == NULL) || (strcmp(output_path, "-") == 0)) {
+      file = stdout;
+    }
+    else {
+      file = fopen(output_path, "w");
+      if (file == NULL) { fprintf(stderr, 
+        "ERROR: Failed to open '%s' for writing.\n", output_path);
+        return(1);
+      }
+    }
+    headless_configure(rate, period, file, raw);
+    output = &headless_output;
   }
-  // create a port for MIDI output
-  jack_port = jack_port_register(jack_client, "out", 
-    JACK_DEFAULT_MIDI_TYPE, JackPortIsOutput | JackPortIsTerminal, 0);
-  if (jack_port == NULL) { fprintf(stderr, 
-    "ERROR: Failed to create a JACK output port.\n");
-    return(1);
+  else if (serial_path != NULL) {
+    serial_configure(serial_path);
+    output = &serial_output;
   }
-  // activate the client for sending MIDI
-  result = jack_set_process_callback(jack_client, jack_process, NULL);
-  if (result != 0) { fprintf(stderr, 
-    "ERROR: Failed to bind a JACK processing callback (error %i).\n", result);
-    return(1);
+  else if (osc_target != NULL) {
+    osc_configure(osc_target);
+    output = &osc_output;
   }
-  result = jack_activate(jack_client);
-  if (result != 0) { fprintf(stderr, 
-    "ERROR: Failed to activate JACK client (error %i).\n", result);
+  else {
+#ifdef HAVE_JACK
+    output = &jack_output;
+#else
+    fprintf(stderr, "ERROR: joy2midi was built without JACK, "
+      "so it can only run with --serial, --osc, --replay or --bench.\n");
     return(1);
+#endif
+  }
+  // the output keeps the port names for as long as it runs, which is 
+  //  longer than the config they came from
+  for (option = 0; option < config->port_count; option++) {
+    output_ports[option] = strdup(config->ports[option]);
+    if (output_ports[option] == NULL) return(1);
   }
+  if (! output->start(output_ports, config->port_count, 
+                      config->coalesce_window)) return(1);
   // get the sample rate to convert times
-  jack_sample_rate = jack_get_sample_rate(jack_client);
+  for (option = 0; option < INPUT_CLOCKS; option++) {
+    timebase_init(&input_timebases[option], output->sample_rate());
+  }
+  
+  // measure or replay without devices
+  if (bench) return(run_bench(replay_path, replay_evdev));
+  if ((capture_path != NULL) && (! capture_start(capture_path, 
+        output->sample_rate(), output->frame_time()))) return(1);
+  if (replay_path != NULL) {
+    long replayed = replay_file(replay_path, replay_evdev, &handlers, 
+      replay_clock);
+    output->stop();
+    if ((! capture_stop()) || (replayed < 0)) return(1);
+    if (verbosity >= 1) print_stats();
+    if ((stats_path != NULL) && (! stats_write(stats_path))) {
+      fprintf(stderr, "ERROR: Failed to write statistics to '%s'.\n", 
+        stats_path);
+      return(1);
+    }
+    return(0);
+  }
   
-  // read and translate joystick events
-	while (1) {
-		if (read(device_file, &event, sizeof(JoystickEvent)) != sizeof(JoystickEvent)) {
-			fprintf(stderr, "ERROR: Failed to read from joystick device.\n");
-			return(1);
-		}
-		message = joystick_event_to_midi_message(event);
-		if (message != NULL) send_midi_message(message);
-	}
+  // start reading from devices
+  if (! input_init(argv + optind + 1, argc - optind - 1, &handlers)) return(1);
+  
+  // reload the map file when it changes
+  pthread_t reloader;
+  if (pthread_create(&reloader, NULL, reload_thread, NULL) != 0) {
+    fprintf(stderr, "ERROR: Failed to start watching the map file.\n");
+    return(1);
+  }
+  
+  // run the reader in real time once the other threads have started so 
+  //  they don't inherit its settings
+  if (priority > 0) {
+    int output_priority = output->priority();
+    if ((output_priority > 0) && (priority >= output_priority)) {
+      fprintf(stderr, "WARNING: Reading input at priority %d to stay below "
+        "the output's priority of %d.\n", output_priority - 1, output_priority);
+      priority = output_priority - 1;
+    }
+    if ((priority > 0) && (realtime_schedule(priority)) && (verbosity >= 1)) 
+      printf("Reading input at real-time priority %d\n", priority);
+  }
+  if ((cpu >= 0) && (realtime_pin(cpu)) && (verbosity >= 1)) 
+    printf("Reading input on CPU %d\n", cpu);
+  if (lock) realtime_prefault_stack();
+  
+  // read and translate joystick events, waking up to send inputs that 
+  //  were held back when they come due
+  time_t last_stats = time(NULL);
+  while (1) {
+    if (! input_poll(held_timeout(STATS_INTERVAL * 1000))) {
+      fprintf(stderr, "ERROR: Failed to wait for joystick input.\n");
+      return(1);
+    }
+    send_due_held();
+    if ((verbosity >= 1) && (time(NULL) - last_stats >= STATS_INTERVAL)) {
+      print_stats();
+      last_stats = time(NULL);
+    }
+  }
+
+}
+
+// CONFIGURATION **************************************************************
+
+// parse and compile the map file, returning NULL if it can't be read or, 
+//  when strict, if it has any errors
+Config *load_config(int strict) {
+  int i;
+  static int generation = 0;
+  Config *loaded = (Config *)calloc(1, sizeof(Config));
+  if (loaded == NULL) {
+    fprintf(stderr, "ERROR: Error allocating memory for the map.\n");
+    return(NULL);
+  }
+  loaded->section_count = 1;
+  loaded->generation = ++generation;
+  loaded->ports[0] = strdup(OUTPUT_DEFAULT_PORT);
+  loaded->port_count = 1;
+  if (loaded->ports[0] == NULL) {
+    fprintf(stderr, "ERROR: Error allocating memory for the map.\n");
+    free(loaded);
+    return(NULL);
+  }
+  // map the file into memory so the lexer can read it directly, which is 
+  //  safe when reloading because that waits for writers to close the file
+  struct stat info;
+  void *mapped = NULL;
+  int fd = open(map_path, O_RDONLY);
+  if ((fd < 0) || (fstat(fd, &info) != 0)) { fprintf(stderr, 
+    "ERROR: Failed to open map file at '%s' for reading.\n", map_path);
+    if (fd >= 0) close(fd);
+    free(loaded);
+    return(NULL);
+  }
+  map_text = "";
+  map_length = info.st_size;
+  if (map_length > 0) {
+    mapped = mmap(NULL, map_length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) { fprintf(stderr, 
+      "ERROR: Failed to read map file at '%s'.\n", map_path);
+      close(fd);
+      free(loaded);
+      return(NULL);
+    }
+    map_text = (const char *)mapped;
+  }
+  close(fd);
+  // parse the map file
+  loading_config = loaded;
+  int errors = parse_map();
+  loading_config = NULL;
+  if (mapped != NULL) munmap(mapped, map_length);
+  map_text = NULL;
+  map_length = 0;
+  if ((strict) && (errors > 0)) {
+    free_config(loaded);
+    return(NULL);
+  }
+  // keep track of mappings with filters, which each device keeps the 
+  //  state of separately
+  if (loaded->mapping_count > 0) {
+    loaded->filtered = 
+      (Mapping **)calloc(loaded->mapping_count, sizeof(Mapping *));
+    if (loaded->filtered == NULL) { fprintf(stderr, 
+      "ERROR: Error allocating memory for the map.\n");
+      free_config(loaded);
+      return(NULL);
+    }
+  }
+  for (i = 0; i < loaded->section_count; i++) {
+    Mapping *mapping;
+    for (mapping = loaded->sections[i].head; mapping != NULL; 
+         mapping = (Mapping *)mapping->next) {
+      if ((mapping->options.filter.cutoff > 0) || 
+          (mapping->options.filter.deadband > 0) || 
+          (mapping->options.filter.interval > 0)) {
+        mapping->filter_index = loaded->filtered_count;
+        loaded->filtered[loaded->filtered_count++] = mapping;
+      }
+    }
+  }
+  // compile mappings for fast lookup
+  for (i = 0; i < loaded->section_count; i++) {
+    MapSection *section = &loaded->sections[i];
+    section->table = table_compile(section->head, loaded->use_tables);
+    // the table owns the mappings now
+    section->head = section->tail = NULL;
+    if (section->table == NULL) { fprintf(stderr, 
+      "ERROR: Failed to allocate memory for the mapping table.\n");
+      free_config(loaded);
+      return(NULL);
+    }
+  }
+  return(loaded);
+}
+
+// free a config and everything in it
+void free_config(Config *freeing) {
+  int i;
+  Mapping *mapping, *next;
+  if (freeing == NULL) return;
+  for (i = 0; i < freeing->section_count; i++) {
+    MapSection *section = &freeing->sections[i];
+    for (mapping = section->head; mapping != NULL; mapping = next) {
+      next = (Mapping *)mapping->next;
+      free(mapping);
+    }
+    table_free(section->table);
+    free(section->match);
+  }
+  for (i = 0; i < freeing->port_count; i++) free(freeing->ports[i]);
+  free(freeing->filtered);
+  free(freeing);
+}
+
+// get the active config and mark it as in use by the reader thread
+Config *acquire_config(void) {
+  Config *active;
+  // make sure the config didn't change before it was marked as in use, 
+  //  since it could have been freed in that time
+  do {
+    active = __atomic_load_n(&config, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&config_in_use, active, __ATOMIC_SEQ_CST);
+  } while (__atomic_load_n(&config, __ATOMIC_SEQ_CST) != active);
+  return(active);
+}
+
+// mark that the reader thread is done with the config
+void release_config(void) {
+  __atomic_store_n(&config_in_use, NULL, __ATOMIC_SEQ_CST);
+}
+
+// replace the active config and free the old one when it's out of use
+void publish_config(Config *loaded) {
+  Config *old = __atomic_exchange_n(&config, loaded, __ATOMIC_SEQ_CST);
+  __atomic_store_n(&verbosity, loaded->verbosity, __ATOMIC_RELAXED);
+  while (__atomic_load_n(&config_in_use, __ATOMIC_SEQ_CST) == old) {
+    usleep(1000);
+  }
+  free_config(old);
+}
+
+// write statistics, warning if they can't be written
+void write_stats(void) {
+  if ((! stats_write(stats_path)) && (verbosity >= 1)) {
+    fprintf(stderr, "WARNING: Failed to write statistics to '%s'.\n", 
+      stats_path);
+  }
+}
 
+// get the signals the reload thread handles, which include the ones that 
+//  end the program when capturing so the capture can be finished
+void handled_signals(sigset_t *signals) {
+  sigemptyset(signals);
+  sigaddset(signals, SIGHUP);
+  sigaddset(signals, SIGUSR1);
+  if (capture_path != NULL) {
+    sigaddset(signals, SIGINT);
+    sigaddset(signals, SIGTERM);
+  }
+}
+
+// reload the map file whenever it changes or we get a SIGHUP, write 
+//  statistics periodically or when we get a SIGUSR1, and finish any 
+//  capture when we're told to quit, which keeps file access out of the 
+//  reader and output threads
+void *reload_thread(void *arg) {
+  char directory[PATH_MAX];
+  char name[PATH_MAX];
+  char scratch[PATH_MAX];
+  char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  // dirname and basename can modify their argument and return a pointer 
+  //  into it, so give them a copy of the path each
+  snprintf(scratch, sizeof(scratch), "%s", map_path);
+  snprintf(directory, sizeof(directory), "%s", dirname(scratch));
+  snprintf(scratch, sizeof(scratch), "%s", map_path);
+  snprintf(name, sizeof(name), "%s", basename(scratch));
+  // editors often replace the file, so watch its directory
+  int inotify_fd = inotify_init();
+  if ((inotify_fd < 0) || (inotify_add_watch(inotify_fd, directory, 
+        IN_CLOSE_WRITE | IN_MOVED_TO) < 0)) {
+    fprintf(stderr, "WARNING: Failed to watch '%s' for changes.\n", map_path);
+  }
+  sigset_t reload_signals;
+  handled_signals(&reload_signals);
+  int signal_fd = signalfd(-1, &reload_signals, 0);
+  struct pollfd fds[2] = {
+    { inotify_fd, POLLIN, 0 },
+    { signal_fd, POLLIN, 0 }
+  };
+  time_t last_stats = time(NULL);
+  while (1) {
+    int ready = poll(fds, 2, (stats_path != NULL) ? stats_interval * 1000 : -1);
+    if ((stats_path != NULL) && 
+        (time(NULL) - last_stats >= stats_interval)) {
+      write_stats();
+      last_stats = time(NULL);
+    }
+    if (ready <= 0) continue;
+    int changed = 0;
+    if (fds[0].revents & POLLIN) {
+      ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+      char *p;
+      for (p = buffer; p < buffer + length; 
+           p += sizeof(struct inotify_event) + ((struct inotify_event *)p)->len) {
+        struct inotify_event *notice = (struct inotify_event *)p;
+        if ((notice->len > 0) && (strcmp(notice->name, name) == 0)) changed = 1;
+      }
+    }
+    if (fds[1].revents & POLLIN) {
+      struct signalfd_siginfo info;
+      if (read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+        if (info.ssi_signo == SIGUSR1) write_stats();
+        else if (info.ssi_signo == SIGHUP) changed = 1;
+        else exit(capture_stop() ? 0 : 1);
+      }
+    }
+    if (! changed) continue;
+    // keep the mappings we have if there's anything wrong with the new ones
+    Config *loaded = load_config(1);
+    if (loaded == NULL) {
+      fprintf(stderr, "ERROR: Keeping the previous mappings.\n");
+      continue;
+    }
+    // ports can't come and go while other programs are connected to them
+    if (! same_ports(loaded)) {
+      fprintf(stderr, "ERROR: Ports only change on a restart, "
+        "so keeping the previous mappings.\n");
+      free_config(loaded);
+      continue;
+    }
+    publish_config(loaded);
+    if (verbosity >= 1) printf("Reloaded '%s'\n", map_path);
+  }
+  return(NULL);
 }
 
 // MAPPINGS *******************************************************************
 
 // add a mapping to the linked list
-void add_mapping(MapSpec inspec, MapSpec outspec) {
+void add_mapping(MapSpec inspec, MapSpec outspec, MapOptions options) {
   // make a new mapping entry
   Mapping *entry = (Mapping *)malloc(sizeof(Mapping));
   if (entry == NULL) {
@@ -172,31 +645,228 @@ void add_mapping(MapSpec inspec, MapSpec outspec) {
   // initialize the mapping
   entry->inspec = inspec;
   entry->outspec = outspec;
+  entry->options = options;
+  entry->transform.table = NULL;
+  entry->filter_index = -1;
+  entry->kind = (inspec.type == AXIS) ? INPUT_AXIS : INPUT_BUTTON;
+  entry->ignore = (outspec.type == IGNORE);
   entry->next = NULL;
   // begin the list if there isn't one
-  if (map_head == NULL) {
-    map_head = entry;
-    map_tail = entry;
+  MapSection *section = &loading_config->sections[loading_config->current_section];
+  if (section->head == NULL) {
+    section->head = entry;
+    section->tail = entry;
   }
   // otherwise extend the list
   else {
-    map_tail->next = entry;
-    map_tail = entry;
+    section->tail->next = entry;
+    section->tail = entry;
   }
+  loading_config->mapping_count++;
+}
+
+// start a section of mappings for devices matching the given text
+void begin_section(char *match) {
+  Config *loading = loading_config;
+  if (loading->section_count >= MAX_SECTIONS) {
+    yyerror("too many device sections");
+    free(match);
+    return;
+  }
+  loading->current_section = loading->section_count++;
+  loading->sections[loading->current_section].match = match;
+}
+
+// add an output port with the given name
+void declare_port(char *name) {
+  Config *loading = loading_config;
+  int i;
+  for (i = 0; i < loading->port_count; i++) {
+    if (strcmp(loading->ports[i], name) == 0) {
+      yyerror("the port has already been declared");
+      free(name);
+      return;
+    }
+  }
+  if ((strlen(name) == 0) || (strlen(name) > OUTPUT_MAX_PORT_NAME)) {
+    yyerror("port names must have from 1 to 32 characters");
+    free(name);
+    return;
+  }
+  if (loading->port_count >= OUTPUT_MAX_PORTS) {
+    yyerror("too many ports");
+    free(name);
+    return;
+  }
+  loading->ports[loading->port_count++] = name;
+}
+
+// get the index of a declared output port
+int find_port(char *name) {
+  Config *loading = loading_config;
+  int i;
+  for (i = 0; i < loading->port_count; i++) {
+    if (strcmp(loading->ports[i], name) == 0) break;
+  }
+  if (i == loading->port_count) {
+    yyerror("the port has to be declared before mappings can use it");
+    i = 0;
+  }
+  free(name);
+  return(i);
+}
+
+// check whether a config has the same output ports as the one that was 
+//  loaded when the output started
+int same_ports(Config *loaded) {
+  int i;
+  if (loaded->port_count != output_port_count()) return(0);
+  for (i = 0; i < loaded->port_count; i++) {
+    if (strcmp(loaded->ports[i], output_ports[i]) != 0) return(0);
+  }
+  return(1);
+}
+
+// find the section of mappings to use for a device
+int find_section(Config *active, const char *name, const char *path) {
+  int i;
+  for (i = 1; i < active->section_count; i++) {
+    if (strstr(name, active->sections[i].match) != NULL) return(i);
+    if (strcmp(path, active->sections[i].match) == 0) return(i);
+  }
+  return(0);
+}
+
+// DEVICES ********************************************************************
+
+// choose the mappings for a device when it's opened
+void device_opened(InputDevice *device) {
+  // look up the section when the first events come in
+  device->section_generation = 0;
+  debounce_init(&device->debounce);
+  device->filters = NULL;
+  device->filter_keys = NULL;
+  device->filter_count = 0;
+  int i;
+  for (i = 0; i < MAX_DEVICES; i++) {
+    if (open_devices[i] == NULL) {
+      open_devices[i] = device;
+      break;
+    }
+  }
+}
+
+// send everything a device is still holding back when it goes away, at 
+//  the times it comes due, so its notes don't stay on and its controllers 
+//  end up where they stopped
+void device_closed(InputDevice *device) {
+  int i;
+  uint64_t due;
+  Config *active = acquire_config();
+  while (device_next_held(active, device, &due)) {
+    send_held(active, device, due + 1);
+  }
+  release_config();
+  for (i = 0; i < MAX_DEVICES; i++) {
+    if (open_devices[i] == device) open_devices[i] = NULL;
+  }
+  free(device->filters);
+  free(device->filter_keys);
+  device->filters = NULL;
+  device->filter_keys = NULL;
+  device->filter_count = 0;
+}
+
+// make sure a device is using a section from the given config
+void resolve_section(Config *active, InputDevice *device) {
+  if (device->section_generation == active->generation) return;
+  device->section = find_section(active, device->name, device->path);
+  device->section_generation = active->generation;
+  resolve_filters(active, device);
+  if ((verbosity >= 1) && (device->section > 0)) {
+    printf("Using mappings for \"%s\" with '%s'\n", 
+      active->sections[device->section].match, device->path);
+  }
+}
+
+// set up a device's filters for the mappings in a config, carrying over 
+//  the state of filters on mappings that are still there so values held 
+//  back before the map file was reloaded still get sent (this allocates, 
+//  but only when the map file is reloaded)
+void resolve_filters(Config *active, InputDevice *device) {
+  int i, j;
+  int count = active->filtered_count;
+  FilterState *filters = 
+    (FilterState *)calloc((count > 0) ? count : 1, sizeof(FilterState));
+  MappingKey *keys = 
+    (MappingKey *)calloc((count > 0) ? count : 1, sizeof(MappingKey));
+  if ((filters == NULL) || (keys == NULL)) {
+    fprintf(stderr, "WARNING: Failed to allocate filters for '%s'.\n", 
+      device->path);
+    free(filters);
+    free(keys);
+    filters = NULL;
+    keys = NULL;
+    count = 0;
+  }
+  for (i = 0; i < count; i++) {
+    keys[i] = mapping_key(active->filtered[i]);
+    for (j = 0; j < device->filter_count; j++) {
+      if (! same_mapping_key(&keys[i], &device->filter_keys[j])) continue;
+      filters[i] = device->filters[j];
+      // each old state only goes to one new mapping
+      device->filter_keys[j].port = -1;
+      break;
+    }
+  }
+  free(device->filters);
+  free(device->filter_keys);
+  device->filters = filters;
+  device->filter_keys = keys;
+  device->filter_count = count;
+}
+
+// translate a batch of events from a device
+void device_events(InputDevice *device, JoystickEvent *events, int count) {
+  MidiMessage messages[MAX_FANOUT];
+  int i;
+  // use the same mappings for the whole batch
+  Config *active = acquire_config();
+  resolve_section(active, device);
+  // send inputs held back from before the batch first
+  if (count > 0) send_held(active, device, events[0].time);
+  // all events in the batch were received at the same time
+  uint32_t now = output->frame_time();
+  Timebase *timebase = &input_timebases[device->clock];
+  for (i = 0; i < count; i++) {
+    // correlate the kernel's timestamp with the output clock
+    timebase_observe(timebase, events[i].time, now);
+    // send releases that came due before the event, so a new press 
+    //  follows the release it comes after
+    send_releases(active, device, events[i].time + 1);
+    // ignore chatter from buttons using the device's own timestamps
+    if ((events[i].type == JS_EVENT_BUTTON) && 
+        (! debounce_button(&active->debounce, &device->debounce, 
+          events[i].number, events[i].value, events[i].time))) continue;
+    int sent = joystick_event_to_midi_messages(active, device, 
+      events[i], messages);
+    if (sent > 0) send_midi_messages(messages, sent);
+  }
+  release_config();
 }
 
 // JOYSTICK => MIDI TRANSLATION ***********************************************
 
 // fill in the data for a MIDI message
-MidiMessage *make_midi_message(int type, int number, int value) {
-  // allocate a message
-  MidiMessage *message = (MidiMessage *)malloc(sizeof(MidiMessage));
-  if (message == NULL) return(NULL);
-  message->next = NULL;
+void make_midi_message(MidiMessage *message, int type, int number, int value, 
+                       int channel) {
+  int i;
+  message->size = 3;
+  message->group = MIDI_GROUP_NONE;
   // clamp parameters
   if (value < 0) value = 0;
   if (number < 0) number = 0;
-  if (number > 127) number = 127;
+  if ((type != NRPN) && (number > 127)) number = 127;
   // map to a MIDI message
   if (type == NOTE) {
     if (value > 127) value = 127;
@@ -217,123 +887,96 @@ MidiMessage *make_midi_message(int type, int number, int value) {
     message->data[1] = value & 0x7F;        // bend amount LSB (7 bits)
     message->data[2] = (value >> 7) & 0x7F; // bend amount MSB (7 bits)
   }
-  // add the channel to send on
-  message->data[0] |= channel;
-  return(message);
-}
-
-// filter messages that don't change the state
-MidiMessage *dedup_filter(MidiMessage *message) {
-  static int notes[128];
-  static int controls[128];
-  static int bend = 0;
-  // allow safe chaining of filters
-  if (message == NULL) return(NULL);
-  // keep the message by default
-  int keep = 1;
-  // remove channel information for easy comparison
-  int type = message->data[0] & 0xF0;
-  int number = message->data[1] & 0x7F;
-  int value = message->data[2] & 0x7F;
-  // note on
-  if (type == 0x90) {
-    if (notes[number] == 1) keep = 0;
-    else notes[number] = 1;
-  }
-  // note off
-  else if (type == 0x80) {
-    if (notes[number] == 0) keep = 0;
-    else notes[number] = 0;
-  }
-  // control change
-  else if (type == 0xB0) {
-    if (controls[number] == value) keep = 0;
-    else controls[number] = value;
-  }
-  // pitch bend
-  else if (type == 0xE0) {
-    value = (value << 7) | number;
-    if (bend == value) keep = 0;
-    else bend = value;
-  }
-  // keep or discard the message
-  if (keep) {
-    return(message);
+  else if (type == CONTROL14) {
+    if (value > 0x3FFF) value = 0x3FFF;
+    if (number > 31) number = 31;
+    message->size = 6;
+    message->group = MIDI_GROUP_CONTROL14;
+    message->data[0] = 0xB0;                // control change
+    message->data[1] = number;              // MSB control number
+    message->data[2] = (value >> 7) & 0x7F; // value MSB (7 bits)
+    message->data[3] = 0xB0;                // control change
+    message->data[4] = number + 32;         // LSB control number
+    message->data[5] = value & 0x7F;        // value LSB (7 bits)
   }
-  else {
-    free(message);
-    return(NULL);
+  else if (type == NRPN) {
+    if (value > 0x3FFF) value = 0x3FFF;
+    if (number > 0x3FFF) number = 0x3FFF;
+    message->size = 12;
+    message->group = MIDI_GROUP_NRPN;
+    message->data[0] = 0xB0;                 // control change
+    message->data[1] = 99;                   // NRPN parameter MSB
+    message->data[2] = (number >> 7) & 0x7F;
+    message->data[3] = 0xB0;                 // control change
+    message->data[4] = 98;                   // NRPN parameter LSB
+    message->data[5] = number & 0x7F;
+    message->data[6] = 0xB0;                 // control change
+    message->data[7] = 6;                    // data entry MSB
+    message->data[8] = (value >> 7) & 0x7F;
+    message->data[9] = 0xB0;                 // control change
+    message->data[10] = 38;                  // data entry LSB
+    message->data[11] = value & 0x7F;
   }
+  // add the channel to send on
+  for (i = 0; i < message->size; i += 3) message->data[i] |= channel;
 }
 
-// filter messages that come too soon after the last of of that type
-MidiMessage *debounce_filter(MidiMessage *message) {
-  static jack_nframes_t note_times[128];
-  // allow safe chaining of filters
-  if (message == NULL) return(NULL);
-  // keep the message by default
-  int keep = 1;
-  // remove channel information for easy comparison
-  int type = message->data[0] & 0xF0;
-  int number = message->data[1] & 0x7F;
-  // restrict the minimum interval between note on events for the same note
-  if (type == 0x90) {
-    // get the current time
-    jack_nframes_t now = jack_frame_time(jack_client);
-    if (note_times[number] > 0) {
-      // get the interval in milliseconds
-      int interval = ((now - note_times[number]) * 1000) / jack_sample_rate;
-      if (interval < debounce) keep = 0;
-    }
-    if (keep != 0) note_times[number] = now;
-  } 
-  // keep or discard the message
-  if (keep) {
-    return(message);
-  }
-  else {
-    free(message);
-    return(NULL);
-  }
+// filter messages that don't change the state of their channel, or the 
+//  parts of message groups that don't, returning 0 if nothing is left
+int dedup_filter(MidiMessage *message) {
+  message->size = midi_state_filter(&sent_state[message->port], 
+    message->data, message->size, message->group);
+  return(message->size > 0);
 }
 
-// map a joystick event to a MIDI message
-MidiMessage *joystick_event_to_midi_message(JoystickEvent event) {
-  int range;
-  float value;
-  // get the mapspec type to search for
-  int type;
-  if (event.type == JS_EVENT_BUTTON) type = BUTTON;
-  else if (event.type == JS_EVENT_AXIS) type = AXIS;
+// fill in the message a mapping sends for an input value, stamped with the 
+//  frame the input happened at, or return 0 if it would change nothing
+int mapping_message(Config *active, Mapping *mapping, int value, 
+                    uint32_t frame, MidiMessage *message) {
+  // fill in the data of the midi message
+  int channel = (mapping->options.channel >= 0) ? 
+    mapping->options.channel : active->channel;
+  make_midi_message(message, mapping->outspec.type, mapping->outspec.number, 
+    mapping_transform(mapping, value), channel);
+  message->port = mapping->options.port;
+  // filter redundant messages
+  if (! dedup_filter(message)) return(0);
+  // stamp the message with when the input happened
+  message->time = frame;
+  return(1);
+}
+
+// map a joystick event to the MIDI messages of every mapping that matches 
+//  it, filling in up to MAX_FANOUT messages and returning how many there are
+int joystick_event_to_midi_messages(Config *active, InputDevice *device, 
+                                    JoystickEvent event, 
+                                    MidiMessage *messages) {
+  int i, count = 0;
+  Timebase *timebase = &input_timebases[device->clock];
+  // get the kind of input to search for
+  int kind;
+  if (event.type == JS_EVENT_BUTTON) kind = INPUT_BUTTON;
+  else if (event.type == JS_EVENT_AXIS) kind = INPUT_AXIS;
   // skip events we don't use
-  else return(NULL);
-  // search mappings
-  Mapping *mapping = NULL;
-  for (mapping = map_head; mapping != NULL; mapping = mapping->next) {
-    // filter events
-    if (type != mapping->inspec.type) continue;
-    if (event.number != mapping->inspec.number) continue;
-    if (event.value < mapping->inspec.min) continue;
-    if (event.value > mapping->inspec.max) continue;
-    // if we're ignoring this input, we're done
-    if (mapping->outspec.type == IGNORE) return(NULL);
-    // map the value onto the range 0.0 to 1.0 so we can transform 
-    //  to the output range
-    range = mapping->inspec.max - mapping->inspec.min;
-    if (range > 0) 
-      value = (float)(event.value - mapping->inspec.min) / (float)range;
-    else 
-      value = 1.0;
-    // map to the output range
-    range = mapping->outspec.max - mapping->outspec.min;
-    value = (float)mapping->outspec.min + ((value * (float)range));
-    // fill in the data of the midi message
-    MidiMessage *message = make_midi_message(
-      mapping->outspec.type, mapping->outspec.number, (int)round(value));
-    // filter redundant messages
-    message = debounce_filter(message);
-    message = dedup_filter(message);
-    return(message);
+  else return(0);
+  // find the mappings that match the input, which there are none of if 
+  //  we're ignoring it
+  const MapInterval *interval = table_lookup(
+    active->sections[device->section].table, kind, event.number, event.value);
+  if (interval != NULL) {
+    for (i = 0; i < interval->count; i++) {
+      Mapping *mapping = interval->mappings[i];
+      // reduce jitter before doing any work on the value
+      int value = event.value;
+      if ((mapping->filter_index >= 0) && 
+          (mapping->filter_index < device->filter_count) && 
+          (! filter_input(&mapping->options.filter, 
+            &device->filters[mapping->filter_index], mapping->inspec.min, 
+            mapping->inspec.max, event.time, &value))) continue;
+      if (mapping_message(active, mapping, value, 
+            timebase_frame(timebase, event.time), &messages[count])) count++;
+    }
+    return(count);
   }
   // report on unhandled events
   if (verbosity >= 2) {
@@ -344,67 +987,319 @@ MidiMessage *joystick_event_to_midi_message(JoystickEvent event) {
       printf("Unmapped joystick axis %d: %d\n", event.number, event.value);
     }
   }
-  return(NULL);
+  return(0);
 }
 
 // MIDI OUTPUT ****************************************************************
 
-void send_midi_message(MidiMessage *message) {
-  // obtain a lock so we don't interfere with JACK processing
-  pthread_mutex_t *lock = &(process_lock);
-  pthread_mutex_lock(lock);
-    // get the time of the message within the current processing block
-    message->time = 
-      jack_frame_time(jack_client) - jack_last_frame_time(jack_client);
-    // queue messages for sending
-    if (messages_tail == NULL) {
-      messages_head = messages_tail = message;
+void send_midi_messages(MidiMessage *messages, int count) {
+  MidiEvent events[MAX_FANOUT];
+  int i, j;
+  for (i = 0; i < count; i++) {
+    events[i].time = messages[i].time;
+    events[i].size = messages[i].size;
+    events[i].group = messages[i].group;
+    events[i].port = messages[i].port;
+    events[i].spilled = 0;
+    memcpy(events[i].data, messages[i].data, messages[i].size);
+  }
+  // queue the messages for sending together without waiting on the 
+  //  output thread
+  if (! output_send_batch(events, count)) {
+    if (verbosity >= 1) {
+      OutputStats stats;
+      output_get_stats(&stats);
+      fprintf(stderr, "WARNING: MIDI output queue is full (%u dropped).\n", 
+        stats.dropped);
     }
-    else {
-      messages_tail->next = (void *)message;
-      messages_tail = message;
+  }
+  else if (verbosity >= 3) {
+    for (i = 0; i < count; i++) {
+      printf("send:");
+      for (j = 0; j < messages[i].size; j++) 
+        printf(" %02X", messages[i].data[j]);
+      printf("\n");
     }
-    if (verbosity >= 3) {
-	    printf("send: %02X %02X %02X\n", 
-	      message->data[0], message->data[1], message->data[2]);
-	  }
-	pthread_mutex_unlock(lock);
-}
-
-static int jack_process(jack_nframes_t nframes, void *context) {
-  unsigned char *midi_buffer;
-  // get a writable buffer for the port and clear it for writing
-  void *port_buffer = jack_port_get_buffer(jack_port, nframes);
-  if (port_buffer == NULL) return(0);
-  jack_midi_clear_buffer(port_buffer);
-  // if the queue is empty we don't need to process anything
-  if (messages_head == NULL) return(0);
-  // obtain a lock so nothing changes the send queue while we're sending it
-  pthread_mutex_t *lock = &(process_lock);
-  pthread_mutex_lock(lock);
-    // initialize time counters
-    jack_nframes_t last_message_time = 0;
-    jack_nframes_t time = 0;
-    // dequeue messages
-    MidiMessage *message = NULL;
-    for (message = messages_head; message != NULL; 
-           message = (MidiMessage *)message->next) {
-      // make sure messages are sequential with only one per frame
-      time = message->time;
-      if (time < 0) time = 0;
-      if (time >= nframes) time = nframes - 1;
-      if (time <= last_message_time) time = last_message_time + 1;
-      // send and free the message
-      midi_buffer = jack_midi_event_reserve(port_buffer, time, 3);
-      if (midi_buffer != NULL) memcpy(midi_buffer, message->data, 3);
-      free(message);
-      // store the message time for the next go
-      last_message_time = time;
+  }
+}
+
+// HELD INPUTS ****************************************************************
+
+// get the earliest time on any clock that a held input comes due, 
+//  returning 0 if nothing is held
+int next_held(Config *active, uint64_t *due) {
+  int i, found = 0;
+  uint64_t next;
+  for (i = 0; i < MAX_DEVICES; i++) {
+    if ((open_devices[i] == NULL) || 
+        (! device_next_held(active, open_devices[i], &next))) continue;
+    if ((! found) || (next < *due)) *due = next;
+    found = 1;
+  }
+  return(found);
+}
+
+// get the earliest time on its clock that an input a device held back 
+//  comes due, returning 0 if nothing is held
+int device_next_held(Config *active, InputDevice *device, uint64_t *due) {
+  int i;
+  int found = debounce_next(&device->debounce, due);
+  // bring filter states from before a reload up to date
+  resolve_section(active, device);
+  for (i = 0; i < device->filter_count; i++) {
+    FilterState *state = &device->filters[i];
+    if (! state->pending) continue;
+    if ((! found) || (state->deadline < *due)) *due = state->deadline;
+    found = 1;
+  }
+  return(found);
+}
+
+// send the button releases a device held back that came due before a time 
+//  on its clock, each at the time it came due
+void send_releases(Config *active, InputDevice *device, uint64_t before) {
+  MidiMessage messages[MAX_FANOUT];
+  JoystickEvent event;
+  uint64_t time;
+  int number;
+  while (debounce_release(&device->debounce, before, &number, &time)) {
+    resolve_section(active, device);
+    event.time = time;
+    event.type = JS_EVENT_BUTTON;
+    event.number = number;
+    event.value = 0;
+    int sent = joystick_event_to_midi_messages(active, device, event, 
+      messages);
+    if (sent > 0) send_midi_messages(messages, sent);
+  }
+}
+
+// send the inputs a device's filters held back that came due before a time 
+//  on its clock, each at the time it came due, and then its held releases
+void send_held(Config *active, InputDevice *device, uint64_t before) {
+  MidiMessage messages[MAX_FANOUT];
+  int i, value, count = 0;
+  resolve_section(active, device);
+  for (i = 0; i < device->filter_count; i++) {
+    Mapping *mapping = active->filtered[i];
+    FilterState *state = &device->filters[i];
+    if ((! state->pending) || (state->deadline >= before)) continue;
+    uint64_t time = state->deadline;
+    if (! filter_flush(&mapping->options.filter, state, 
+        mapping->inspec.min, mapping->inspec.max, &value)) continue;
+    if (! mapping_message(active, mapping, value, 
+        timebase_frame(&input_timebases[device->clock], time), 
+        &messages[count])) continue;
+    if (++count == MAX_FANOUT) {
+      send_midi_messages(messages, count);
+      count = 0;
     }
-    // clear the queue
-    messages_head = NULL;
-    messages_tail = NULL;
-  pthread_mutex_unlock(lock);
+  }
+  if (count > 0) send_midi_messages(messages, count);
+  send_releases(active, device, before);
+}
+
+// get how many milliseconds the reader has to wait until a time on a clock
+int wait_until(int clock, uint64_t due, uint32_t now, uint32_t rate) {
+  int32_t frames = 
+    (int32_t)(timebase_frame(&input_timebases[clock], due) - now);
+  return((frames <= 0) ? 0 : 
+    (int)((((int64_t)frames * 1000) + rate - 1) / rate));
+}
+
+// get how many milliseconds the reader can wait for input before a held 
+//  input comes due, up to a limit
+int held_timeout(int limit) {
+  int i, wait;
+  uint64_t due;
+  Config *active = acquire_config();
+  uint32_t now = output->frame_time();
+  uint32_t rate = output->sample_rate();
+  for (i = 0; i < MAX_DEVICES; i++) {
+    InputDevice *device = open_devices[i];
+    if ((device == NULL) || (! device_next_held(active, device, &due))) 
+      continue;
+    wait = wait_until(device->clock, due, now, rate);
+    if (wait < limit) limit = wait;
+  }
+  release_config();
+  return(limit);
+}
+
+// send the held inputs that have come due while waiting for input
+void send_due_held(void) {
+  int i;
+  Config *active = acquire_config();
+  uint32_t now = output->frame_time();
+  for (i = 0; i < MAX_DEVICES; i++) {
+    InputDevice *device = open_devices[i];
+    if ((device == NULL) || 
+        (! input_timebases[device->clock].initialized)) continue;
+    send_held(active, device, 
+      timebase_time(&input_timebases[device->clock], now) + 1);
+  }
+  release_config();
+}
+
+// print statistics about output to the console
+void print_stats(void) {
+  static uint32_t last_sent = 0;
+  OutputStats stats;
+  output_get_stats(&stats);
+  if (stats.sent == last_sent) return;
+  last_sent = stats.sent;
+  printf("Sent %u messages (%u late, %u spilled, %u dropped), "
+         "coalesced %u of %u controller messages (%.1f%%)\n",
+    stats.sent, stats.late, stats.spilled, stats.dropped, 
+    stats.coalesced, stats.continuous, (stats.continuous > 0) ? 
+      (100.0 * stats.coalesced) / stats.continuous : 0.0);
+  if (stats.bytes > 0) {
+    printf("Wrote %u bytes, %u fewer with running status (%.1f%%)\n", 
+      stats.bytes, stats.bytes_saved, 
+      (100.0 * stats.bytes_saved) / (stats.bytes + stats.bytes_saved));
+  }
+  FilterStats filtered;
+  filter_get_stats(&filtered);
+  if (filtered.smoothed + filtered.deadband + filtered.interval > 0) {
+    printf("Filtered out %u input values (%u smoothed, %u in deadbands, "
+           "%u too soon)\n", 
+      filtered.smoothed + filtered.deadband + filtered.interval, 
+      filtered.smoothed, filtered.deadband, filtered.interval);
+  }
+  uint32_t debounced = debounce_suppressed();
+  if (debounced > 0) printf("Ignored %u button events as chatter\n", debounced);
+  uint32_t collapsed = input_collapsed();
+  if (collapsed > 0) {
+    printf("Skipped %u axis events superseded in the same batch\n", 
+      collapsed);
+  }
+}
+
+// REPLAY AND BENCHMARKING ****************************************************
+
+// move the simulated output clock to the time of a replayed event, 
+//  sending held inputs at the times they come due along the way
+void replay_clock(uint64_t time) {
+  static int started = 0;
+  static uint64_t first_time;
+  static uint32_t first_frame;
+  uint64_t due;
+  int i;
+  if (! started) {
+    first_time = time;
+    first_frame = output->frame_time();
+    started = 1;
+  }
+  Config *active = acquire_config();
+  while ((next_held(active, &due)) && (due < time)) {
+    headless_advance(first_frame + (uint32_t)(
+      ((due - first_time) * output->sample_rate()) / 1000000));
+    for (i = 0; i < MAX_DEVICES; i++) {
+      if (open_devices[i] != NULL) send_held(active, open_devices[i], due + 1);
+    }
+  }
+  release_config();
+  headless_advance(first_frame + (uint32_t)(
+    ((time - first_time) * output->sample_rate()) / 1000000));
+}
+
+// the number of synthesized events to translate when benchmarking
+#define BENCH_EVENTS 1000000
+
+// measure how fast the map file translates events, returning the exit code
+int run_bench(const char *replay_path, int replay_evdev) {
+  static JoystickEvent events[BENCH_EVENTS];
+  InputHandlers handlers = { device_opened, device_closed, device_events };
+  InputDevice device;
+  long i, count = 0;
+  // printing to the console would swamp the measurement
+  verbosity = 0;
+  // measure the whole path from input to output
+  unsigned long allocations = bench_allocations();
+  bench_count_allocations(1);
+  uint64_t start = bench_now();
+  if (replay_path != NULL) {
+    count = replay_file(replay_path, replay_evdev, &handlers, replay_clock);
+    if (count < 0) return(1);
+  }
+  else {
+    // sweep all mapped inputs, one per millisecond
+    int swept = bench_synthesize(config->sections[0].table, 
+      events, BENCH_EVENTS);
+    if (swept == 0) {
+      fprintf(stderr, "ERROR: The map file has no mappings to measure.\n");
+      return(1);
+    }
+    memset(&device, 0, sizeof(device));
+    device.fd = -1;
+    strcpy(device.name, "Benchmark");
+    device_opened(&device);
+    for (count = 0; count < BENCH_EVENTS; count++) {
+      events[count] = events[count % swept];
+      events[count].time = (uint64_t)count * 1000;
+    }
+    for (i = 0; i < count; i++) {
+      replay_clock(events[i].time);
+      device_events(&device, &events[i], 1);
+    }
+  }
+  output->stop();
+  uint64_t elapsed = bench_now() - start;
+  bench_count_allocations(0);
+  allocations = bench_allocations() - allocations;
+  printf("Translated %ld events in %.3f s (%.0f events/s, %.1f ns/event)\n", 
+    count, elapsed / 1e9, (count * 1e9) / (elapsed > 0 ? elapsed : 1), 
+    (count > 0) ? (double)elapsed / count : 0.0);
+  if (bench_counts_allocations()) {
+    printf("Allocated memory %lu times (%.4f per event)\n", 
+      allocations, (count > 0) ? (double)allocations / count : 0.0);
+  }
+  print_stats();
+  // measure each stage on its own
+  MapTable *table = config->sections[0].table;
+  int swept = bench_synthesize(table, events, BENCH_EVENTS);
+  printf("Looked up mappings in %.1f ns\n", 
+    bench_lookup(table, events, swept));
+  print_cost("Filtered values", bench_filter(table, events, swept), "event");
+  print_cost("Queued and sent messages", bench_queue(config->port_count), 
+    "message");
+  char stage[64];
+  snprintf(stage, sizeof(stage), "Parsed %d mappings", config->mapping_count);
+  print_cost(stage, bench_parse(), "mapping");
+  if (! bench_counts_allocations()) {
+    printf("(Build with `make bench` to count allocations.)\n");
+  }
   return(0);
 }
 
+// print the cost of a benchmark stage per unit of work, with allocations 
+//  if they're counted
+void print_cost(const char *stage, BenchCost cost, const char *unit) {
+  printf("%s in %.1f ns/%s", stage, cost.ns, unit);
+  if (bench_counts_allocations()) {
+    printf(" (%.4f allocations/%s)", cost.allocations, unit);
+  }
+  printf("\n");
+}
+
+// measure the cost per mapping of loading the map file again
+BenchCost bench_parse(void) {
+  const uint64_t duration = 200000000;
+  BenchCost cost = { 0.0, 0.0 };
+  long loaded = 0;
+  unsigned long allocations = bench_allocations();
+  bench_count_allocations(1);
+  uint64_t start = bench_now(), elapsed;
+  do {
+    Config *parsed = load_config(0);
+    if (parsed == NULL) break;
+    loaded += parsed->mapping_count;
+    free_config(parsed);
+    elapsed = bench_now() - start;
+  } while (elapsed < duration);
+  bench_count_allocations(0);
+  if (loaded == 0) return(cost);
+  cost.ns = (double)elapsed / loaded;
+  cost.allocations = (double)(bench_allocations() - allocations) / loaded;
+  return(cost);
+}
@@ -0,0 +1,289 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mapping.h"
+
+// the widest input range to build a lookup table for
+#define TABLE_MAX_SIZE 65536
+// input ranges narrower than this are cheap enough to compute directly
+#define TABLE_MIN_SIZE 3
+// the number of fractional bits in the fixed-point scale of a transform
+#define SCALE_BITS 40
+
+MapOptions default_map_options(void) {
+  MapOptions options;
+  memset(&options, 0, sizeof(MapOptions));
+  options.curve.type = CURVE_LINEAR;
+  options.channel = -1;
+  return(options);
+}
+
+// get the logistic function of x
+static double logistic(double x) {
+  return(1.0 / (1.0 + exp(- x)));
+}
+
+// apply a curve to a position from 0.0 to 1.0 in the input range, 
+//  returning a position from 0.0 to 1.0 in the output range
+static double curve_apply(const Curve *curve, double x) {
+  int i;
+  double k = (double)curve->steepness;
+  if (curve->type == CURVE_EXPONENTIAL) {
+    if (curve->steepness == 0) return(x);
+    return((exp(k * x) - 1.0) / (exp(k) - 1.0));
+  }
+  else if (curve->type == CURVE_S) {
+    if (curve->steepness <= 0) return(x);
+    double low = logistic(- k / 2.0);
+    double high = logistic(k / 2.0);
+    return((logistic(k * (x - 0.5)) - low) / (high - low));
+  }
+  else if ((curve->type == CURVE_POINTS) && (curve->count > 0)) {
+    double px = x * 100.0;
+    if (px <= curve->x[0]) return(curve->y[0] / 100.0);
+    // interpolate between the breakpoints on either side
+    for (i = 1; i < curve->count; i++) {
+      if (px > curve->x[i]) continue;
+      double span = curve->x[i] - curve->x[i - 1];
+      double t = (span > 0) ? (px - curve->x[i - 1]) / span : 1.0;
+      return((curve->y[i - 1] + (t * (curve->y[i] - curve->y[i - 1]))) / 100.0);
+    }
+    return(curve->y[curve->count - 1] / 100.0);
+  }
+  return(x);
+}
+
+// compute the output for an input value without any precomputed table
+static int transform_compute(const Mapping *mapping, int value) {
+  int64_t offset = value - mapping->inspec.min;
+  int inrange = mapping->inspec.max - mapping->inspec.min;
+  int outrange = mapping->outspec.max - mapping->outspec.min;
+  // a single input value maps to the end of the output range
+  if (inrange <= 0) return(mapping->outspec.max);
+  if (mapping->options.curve.type == CURVE_LINEAR) {
+    // multiply by the reciprocal of the input range with rounding
+    return(mapping->outspec.min + (int)(((offset * mapping->transform.scale) + 
+      (1LL << (SCALE_BITS - 1))) >> SCALE_BITS));
+  }
+  double x = (double)offset / (double)inrange;
+  double y = curve_apply(&mapping->options.curve, x);
+  return(mapping->outspec.min + (int)round(y * (double)outrange));
+}
+
+// precompute the transform for a mapping, returning 0 if memory for a 
+//  lookup table couldn't be allocated
+static int transform_compile(Mapping *mapping, int use_tables) {
+  int i, size, value;
+  Transform *transform = &mapping->transform;
+  int inrange = mapping->inspec.max - mapping->inspec.min;
+  int outrange = mapping->outspec.max - mapping->outspec.min;
+  transform->table = NULL;
+  // round the scale up so values exactly halfway between outputs round up 
+  //  like round() does, which keeps centered axes centered
+  transform->scale = 0;
+  if (inrange > 0) {
+    int64_t numerator = (int64_t)outrange * (1LL << SCALE_BITS);
+    transform->scale = numerator / inrange;
+    if ((numerator > 0) && (numerator % inrange != 0)) transform->scale++;
+  }
+  if (! use_tables) return(1);
+  size = inrange + 1;
+  if ((size < TABLE_MIN_SIZE) || (size > TABLE_MAX_SIZE)) return(1);
+  uint16_t *table = (uint16_t *)malloc(size * sizeof(uint16_t));
+  if (table == NULL) return(0);
+  for (i = 0; i < size; i++) {
+    value = transform_compute(mapping, mapping->inspec.min + i);
+    if (value < 0) value = 0;
+    if (value > 0xFFFF) value = 0xFFFF;
+    table[i] = value;
+  }
+  transform->table = table;
+  return(1);
+}
+
+int mapping_transform(const Mapping *mapping, int value) {
+  if (mapping->transform.table != NULL) 
+    return(mapping->transform.table[value - mapping->inspec.min]);
+  return(transform_compute(mapping, value));
+}
+
+MappingKey mapping_key(const Mapping *mapping) {
+  MappingKey key;
+  key.inspec = mapping->inspec;
+  key.outspec = mapping->outspec;
+  key.port = mapping->options.port;
+  key.channel = mapping->options.channel;
+  return(key);
+}
+
+int same_mapping_key(const MappingKey *a, const MappingKey *b) {
+  return(memcmp(a, b, sizeof(MappingKey)) == 0);
+}
+
+// compare integers for sorting
+static int compare_ints(const void *a, const void *b) {
+  int ia = *(const int *)a;
+  int ib = *(const int *)b;
+  return((ia > ib) - (ia < ib));
+}
+
+// determine whether two intervals resolve to the same mappings
+static int same_mappings(const MapInterval *a, const MapInterval *b) {
+  int i;
+  if (a->count != b->count) return(0);
+  for (i = 0; i < a->count; i++) {
+    if (a->mappings[i] != b->mappings[i]) return(0);
+  }
+  return(1);
+}
+
+// fill in the intervals for one input from the mappings that match it, 
+//  taking lists of mappings from the given storage, and return the number 
+//  of intervals written
+static int compile_bucket(Mapping **matches, int count, int *bounds, 
+                          MapInterval *out, Mapping ***storage) {
+  int i, j, bound_count = 0, interval_count = 0;
+  // every range starts and ends an interval
+  for (i = 0; i < count; i++) {
+    bounds[bound_count++] = matches[i]->inspec.min;
+    bounds[bound_count++] = matches[i]->inspec.max + 1;
+  }
+  qsort(bounds, bound_count, sizeof(int), compare_ints);
+  // resolve each interval between bounds to the mappings that match it
+  for (i = 0; i + 1 < bound_count; i++) {
+    if (bounds[i] == bounds[i + 1]) continue;
+    MapInterval *interval = &out[interval_count];
+    interval->min = bounds[i];
+    interval->max = bounds[i + 1] - 1;
+    interval->count = 0;
+    interval->mappings = *storage;
+    int matched = 0;
+    for (j = 0; j < count; j++) {
+      if ((matches[j]->inspec.min > interval->min) || 
+          (matches[j]->inspec.max < interval->max)) continue;
+      matched = 1;
+      // ignoring an input hides any mappings after it
+      if (matches[j]->ignore) break;
+      if (interval->count >= MAX_FANOUT) break;
+      interval->mappings[interval->count++] = matches[j];
+    }
+    if (! matched) continue;
+    // merge with the last interval if it continues it
+    if ((interval_count > 0) && (out[interval_count - 1].max + 1 == 
+          interval->min) && (same_mappings(&out[interval_count - 1], interval))) {
+      out[interval_count - 1].max = interval->max;
+    }
+    else {
+      *storage += interval->count;
+      interval_count++;
+    }
+  }
+  return(interval_count);
+}
+
+// get the index of the bucket for a mapping's input, or -1 if it can 
+//  never match anything
+static int bucket_index(const Mapping *mapping) {
+  if ((mapping->kind < 0) || (mapping->kind >= INPUT_KINDS)) return(-1);
+  if ((mapping->inspec.number < 0) || 
+      (mapping->inspec.number >= INPUT_NUMBERS)) return(-1);
+  // ranges that are backwards can never match
+  if (mapping->inspec.min > mapping->inspec.max) return(-1);
+  return((mapping->kind * INPUT_NUMBERS) + mapping->inspec.number);
+}
+
+MapTable *table_compile(Mapping *mappings, int use_tables) {
+  int i, count, total = 0, largest = 0;
+  size_t capacity = 0;
+  Mapping *mapping;
+  MapTable *table = (MapTable *)calloc(1, sizeof(MapTable));
+  if (table == NULL) return(NULL);
+  table->mappings = mappings;
+  // count the mappings for each input
+  int starts[(INPUT_KINDS * INPUT_NUMBERS) + 1];
+  memset(starts, 0, sizeof(starts));
+  for (mapping = mappings; mapping != NULL; mapping = mapping->next) {
+    if (! transform_compile(mapping, use_tables)) {
+      table_free(table);
+      return(NULL);
+    }
+    i = bucket_index(mapping);
+    if (i >= 0) starts[i + 1]++;
+    total++;
+  }
+  // each input's n ranges split it into at most 2n - 1 intervals, each 
+  //  with at most n mappings
+  for (i = 0; i < INPUT_KINDS * INPUT_NUMBERS; i++) {
+    count = starts[i + 1];
+    capacity += (size_t)count * ((count < MAX_FANOUT) ? count : MAX_FANOUT);
+    if (count > largest) largest = count;
+    starts[i + 1] += starts[i];
+  }
+  Mapping **sorted = (Mapping **)malloc((total + 1) * sizeof(Mapping *));
+  int *bounds = (int *)malloc((largest + 1) * 2 * sizeof(int));
+  table->intervals = 
+    (MapInterval *)malloc((total + 1) * 2 * sizeof(MapInterval));
+  table->matches = (Mapping **)malloc((capacity * 2 + 1) * sizeof(Mapping *));
+  if ((sorted == NULL) || (bounds == NULL) || 
+      (table->intervals == NULL) || (table->matches == NULL)) {
+    free(sorted);
+    free(bounds);
+    table_free(table);
+    return(NULL);
+  }
+  // sort the mappings by input in one pass, keeping them in order of 
+  //  precedence within each input
+  int filled[INPUT_KINDS * INPUT_NUMBERS];
+  memset(filled, 0, sizeof(filled));
+  for (mapping = mappings; mapping != NULL; mapping = mapping->next) {
+    i = bucket_index(mapping);
+    if (i >= 0) sorted[starts[i] + filled[i]++] = mapping;
+  }
+  MapInterval *next = table->intervals;
+  Mapping **storage = table->matches;
+  for (i = 0; i < INPUT_KINDS * INPUT_NUMBERS; i++) {
+    count = starts[i + 1] - starts[i];
+    if (count == 0) continue;
+    MapBucket *bucket = &table->buckets[i / INPUT_NUMBERS][i % INPUT_NUMBERS];
+    bucket->intervals = next;
+    bucket->count = compile_bucket(sorted + starts[i], count, bounds, 
+      next, &storage);
+    next += bucket->count;
+  }
+  free(sorted);
+  free(bounds);
+  return(table);
+}
+
+void table_free(MapTable *table) {
+  if (table == NULL) return;
+  Mapping *mapping = table->mappings;
+  while (mapping != NULL) {
+    Mapping *next = (Mapping *)mapping->next;
+    free(mapping->transform.table);
+    free(mapping);
+    mapping = next;
+  }
+  free(table->intervals);
+  free(table->matches);
+  free(table);
+}
+
+const MapInterval *table_lookup(const MapTable *table, 
+                                int kind, int number, int value) {
+  if ((kind < 0) || (kind >= INPUT_KINDS)) return(NULL);
+  if ((number < 0) || (number >= INPUT_NUMBERS)) return(NULL);
+  const MapBucket *bucket = &table->buckets[kind][number];
+  // binary search for the interval containing the value
+  int low = 0;
+  int high = bucket->count - 1;
+  while (low <= high) {
+    int middle = (low + high) / 2;
+    const MapInterval *interval = &bucket->intervals[middle];
+    if (value < interval->min) high = middle - 1;
+    else if (value > interval->max) low = middle + 1;
+    else return(interval);
+  }
+  return(NULL);
+}
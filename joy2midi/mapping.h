@@ -0,0 +1,153 @@
+#ifndef JOY2MIDI_MAPPING_H
+#define JOY2MIDI_MAPPING_H
+
+#include <stdint.h>
+
+#include "filter.h"
+
+// kinds of joystick input a mapping can match
+#define INPUT_BUTTON 0
+#define INPUT_AXIS 1
+#define INPUT_KINDS 2
+// the number of inputs of each kind a joystick can report
+#define INPUT_NUMBERS 256
+
+// a struct for input/output mapping specifiers
+typedef struct {
+  int type;
+  int number;
+  int min;
+  int max;
+} MapSpec;
+
+// shapes of response curve from input to output
+#define CURVE_LINEAR 0
+#define CURVE_EXPONENTIAL 1
+#define CURVE_S 2
+#define CURVE_POINTS 3
+// the maximum number of breakpoints in a curve
+#define CURVE_MAX_POINTS 16
+// the default steepness of exponential and S-shaped curves
+#define CURVE_DEFAULT_EXPONENTIAL 3
+#define CURVE_DEFAULT_S 8
+// a response curve from input to output
+typedef struct {
+  int type;
+  // the steepness of exponential and S-shaped curves
+  int steepness;
+  // breakpoints as percentages of the input and output ranges
+  int count;
+  int x[CURVE_MAX_POINTS];
+  int y[CURVE_MAX_POINTS];
+} Curve;
+
+// optional settings for a mapping
+typedef struct {
+  Curve curve;
+  FilterSpec filter;
+  // the output port to send on
+  int port;
+  // the MIDI channel to send on from 0 to 15, or -1 to use the map file's
+  int channel;
+} MapOptions;
+
+// a precomputed transform from input values to output values
+typedef struct {
+  // the output for every input value from inspec.min, or NULL if there's 
+  //  no table and the value must be computed
+  uint16_t *table;
+  // the change in output per unit of input as a fixed-point number
+  int64_t scale;
+} Transform;
+
+// an entry in a linked list of mappings
+typedef struct {
+  MapSpec inspec;
+  MapSpec outspec;
+  MapOptions options;
+  // the kind of input the mapping matches (INPUT_BUTTON or INPUT_AXIS)
+  int kind;
+  // nonzero if the mapping ignores the input instead of sending anything, 
+  //  which also hides the mappings after it
+  int ignore;
+  // the compiled transform from input to output values
+  Transform transform;
+  // where the state of the mapping's filters is in each device's list of 
+  //  filter states, or -1 if the mapping has no filters
+  int filter_index;
+  void *next;
+} Mapping;
+
+// what identifies a mapping from one load of the map file to the next, so 
+//  state kept for it can be carried over
+typedef struct {
+  MapSpec inspec;
+  MapSpec outspec;
+  int port;
+  int channel;
+} MappingKey;
+
+// the most mappings a single input value can drive
+#define MAX_FANOUT 16
+// a range of input values that all resolve to the same mappings
+typedef struct {
+  int min;
+  int max;
+  // the mappings to apply in order, which can be none if the input is 
+  //  ignored
+  int count;
+  Mapping **mappings;
+} MapInterval;
+// the sorted, non-overlapping intervals for one input
+typedef struct {
+  int count;
+  MapInterval *intervals;
+} MapBucket;
+// mappings compiled for direct lookup by input
+typedef struct {
+  MapBucket buckets[INPUT_KINDS][INPUT_NUMBERS];
+  // the list of mappings the table was compiled from, which it owns
+  Mapping *mappings;
+  // storage for the intervals of all buckets
+  MapInterval *intervals;
+  // storage for the lists of mappings of all intervals
+  Mapping **matches;
+} MapTable;
+
+// the most sections a map file can have
+#define MAX_SECTIONS 32
+// a group of mappings that apply to matching devices
+typedef struct {
+  // text to look for in the name or path of a device, or NULL to match 
+  //  devices that no other section matches
+  char *match;
+  // the ends of the linked list of mappings
+  Mapping *head;
+  Mapping *tail;
+  // the mappings compiled for lookup by input
+  MapTable *table;
+} MapSection;
+
+// get options for a mapping with a linear response
+MapOptions default_map_options(void);
+
+// compile a linked list of mappings into a table, with each input value 
+//  resolving to every mapping in the list that matches it (up to 
+//  MAX_FANOUT), in order and stopping at the first one that ignores it, 
+//  or return NULL if memory couldn't be allocated; the table takes 
+//  ownership of the list even on failure, and if use_tables is set, transforms are 
+//  precomputed into lookup tables over the input range
+MapTable *table_compile(Mapping *mappings, int use_tables);
+// free a table along with the mappings it was compiled from
+void table_free(MapTable *table);
+// get the mappings for the given input value, or NULL if none matches
+const MapInterval *table_lookup(const MapTable *table, 
+                                int kind, int number, int value);
+// transform an input value to the mapping's output range
+int mapping_transform(const Mapping *mapping, int value);
+// get what identifies a mapping across reloads
+MappingKey mapping_key(const Mapping *mapping);
+// determine whether two keys are for the same mapping
+int same_mapping_key(const MappingKey *a, const MappingKey *b);
+
+#endif
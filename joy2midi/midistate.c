@@ -0,0 +1,100 @@
+#include <string.h>
+
+#include "midistate.h"
+#include "ring.h"
+
+// test, set and clear bits in a 128-bit set
+#define BIT_TEST(set, bit) ((set)[(bit) >> 3] & (1 << ((bit) & 7)))
+#define BIT_SET(set, bit) ((set)[(bit) >> 3] |= (1 << ((bit) & 7)))
+#define BIT_CLEAR(set, bit) ((set)[(bit) >> 3] &= ~(1 << ((bit) & 7)))
+
+void midi_state_init(MidiState *state) {
+  int channel;
+  memset(state, 0, sizeof(MidiState));
+  for (channel = 0; channel < MIDI_CHANNELS; channel++) {
+    state->bend[channel] = -1;
+    state->nrpn[channel] = -1;
+  }
+}
+
+// determine whether a controller would change and record its new value
+static int control_changes(MidiState *state, int channel, int number, 
+                           int value) {
+  int changed = ((! BIT_TEST(state->known[channel], number)) || 
+                 (state->controls[channel][number] != value));
+  BIT_SET(state->known[channel], number);
+  state->controls[channel][number] = value;
+  return(changed);
+}
+
+// update the state with a single message, returning whether it changes 
+//  anything
+static int message_changes(MidiState *state, const uint8_t *data) {
+  int status = data[0] & 0xF0;
+  int channel = data[0] & 0x0F;
+  int number = data[1] & 0x7F;
+  int value = data[2] & 0x7F;
+  if (status == 0x90) {
+    if (BIT_TEST(state->notes[channel], number)) return(0);
+    BIT_SET(state->notes[channel], number);
+  }
+  else if (status == 0x80) {
+    if (! BIT_TEST(state->notes[channel], number)) return(0);
+    BIT_CLEAR(state->notes[channel], number);
+  }
+  else if (status == 0xB0) {
+    // selecting parameters outside an NRPN group loses track of them
+    if ((number >= 98) && (number <= 101)) state->nrpn[channel] = -1;
+    return(control_changes(state, channel, number, value));
+  }
+  else if (status == 0xE0) {
+    value = (value << 7) | number;
+    if (state->bend[channel] == value) return(0);
+    state->bend[channel] = value;
+  }
+  return(1);
+}
+
+// update the state with a coarse and fine controller pair, returning 
+//  0 if neither changes, 1 if only the fine one does, or 2 if both have to 
+//  be sent because receivers reset the fine value with the coarse one
+static int pair_changes(MidiState *state, int channel, 
+                        const uint8_t *coarse, const uint8_t *fine) {
+  int coarse_changed = control_changes(state, channel, 
+    coarse[1] & 0x7F, coarse[2] & 0x7F);
+  int fine_changed = control_changes(state, channel, 
+    fine[1] & 0x7F, fine[2] & 0x7F);
+  if (coarse_changed) return(2);
+  return(fine_changed);
+}
+
+int midi_state_filter(MidiState *state, uint8_t *data, int size, int group) {
+  int channel = data[0] & 0x0F;
+  if ((group == MIDI_GROUP_CONTROL14) && (size == 6)) {
+    int changes = pair_changes(state, channel, data, data + 3);
+    if (changes == 0) return(0);
+    if (changes == 2) return(6);
+    memmove(data, data + 3, 3);
+    return(3);
+  }
+  if ((group == MIDI_GROUP_NRPN) && (size == 12)) {
+    int parameter = ((data[2] & 0x7F) << 7) | (data[5] & 0x7F);
+    // a newly selected parameter's value isn't known
+    if (state->nrpn[channel] != parameter) {
+      state->nrpn[channel] = parameter;
+      control_changes(state, channel, 6, data[8] & 0x7F);
+      control_changes(state, channel, 38, data[11] & 0x7F);
+      return(12);
+    }
+    // otherwise leave out the selection and anything else that's the same
+    int changes = pair_changes(state, channel, data + 6, data + 9);
+    if (changes == 0) return(0);
+    if (changes == 2) {
+      memmove(data, data + 6, 6);
+      return(6);
+    }
+    memmove(data, data + 9, 3);
+    return(3);
+  }
+  return(message_changes(state, data) ? size : 0);
+}
@@ -0,0 +1,31 @@
+#ifndef JOY2MIDI_MIDISTATE_H
+#define JOY2MIDI_MIDISTATE_H
+
+#include <stdint.h>
+
+// the number of MIDI channels
+#define MIDI_CHANNELS 16
+
+// what has been sent on each MIDI channel, so that messages that wouldn't 
+//  change anything can be left out
+typedef struct {
+  // a bit for each note that's on
+  uint8_t notes[MIDI_CHANNELS][16];
+  // a bit for each controller whose value is known
+  uint8_t known[MIDI_CHANNELS][16];
+  // the last value sent on each controller
+  uint8_t controls[MIDI_CHANNELS][128];
+  // the last pitch bend sent, or -1 if none has been
+  int16_t bend[MIDI_CHANNELS];
+  // the NRPN parameter selected, or -1 if it isn't known
+  int16_t nrpn[MIDI_CHANNELS];
+} MidiState;
+
+// reset to a state where nothing is known to have been sent
+void midi_state_init(MidiState *state);
+// update the state with a group of messages (MIDI_GROUP_...), removing 
+//  the messages that wouldn't change anything, and return the number of 
+//  bytes left
+int midi_state_filter(MidiState *state, uint8_t *data, int size, int group);
+
+#endif
@@ -0,0 +1,292 @@
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "osc_output.h"
+
+// the rate of the frame clock, which sets the resolution of timetags
+#define OSC_RATE 48000
+// the number of frames in each period, which is one millisecond
+#define OSC_PERIOD (OSC_RATE / 1000)
+// the most bytes to send in one datagram, which fits in a single 
+//  ethernet frame
+#define OSC_PACKET_SIZE 1472
+// the room for a message's address and type tags, which is enough for 
+//  the longest port name
+#define OSC_HEADER_SIZE 64
+// the most arguments a message has
+#define OSC_MAX_ARGS 3
+// the number of seconds from the OSC epoch (1900) to the unix epoch (1970)
+#define OSC_EPOCH_OFFSET 2208988800UL
+
+// the kinds of message that get sent
+enum { OSC_NOTE, OSC_CONTROL, OSC_BEND, OSC_KINDS };
+
+// a message with its address and type tags already formatted, so sending 
+//  it only needs the arguments filled in
+typedef struct {
+  uint8_t header[OSC_HEADER_SIZE];
+  // the size of the address and type tags with padding
+  size_t header_size;
+  // the number of 32-bit integer arguments
+  int args;
+} OscTemplate;
+
+// where to send
+static const char *target_spec = NULL;
+static int socket_fd = -1;
+// the thread that sends each period
+static pthread_t sender;
+static int running = 0;
+// nanoseconds to add to the monotonic clock to get the wall clock
+static int64_t wall_offset;
+static OscTemplate templates[OUTPUT_MAX_PORTS][OSC_KINDS];
+// the bundle for the current period, which starts with its fixed header
+static uint8_t packet[OSC_PACKET_SIZE];
+static size_t packet_size;
+// the frame offset in the current period of the earliest message in the 
+//  bundle
+static int32_t first_time;
+
+void osc_configure(const char *target) {
+  target_spec = target;
+}
+
+// get the number of frames the monotonic clock has counted, which the 
+//  frame clock is the low 32 bits of
+static int64_t monotonic_frames(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return(((int64_t)now.tv_sec * OSC_RATE) + 
+    (((int64_t)now.tv_nsec * OSC_RATE) / 1000000000));
+}
+
+static uint32_t osc_time(void) {
+  return((uint32_t)monotonic_frames());
+}
+
+static uint32_t osc_rate(void) {
+  return(OSC_RATE);
+}
+
+// store a 32-bit number in network byte order
+static void put_int32(uint8_t *out, uint32_t value) {
+  out[0] = value >> 24;
+  out[1] = value >> 16;
+  out[2] = value >> 8;
+  out[3] = value;
+}
+
+// write a string with its terminator, padded to a multiple of 4 bytes, 
+//  and return the number of bytes written
+static size_t put_string(uint8_t *out, const char *s) {
+  size_t length = strlen(s) + 1;
+  size_t padded = (length + 3) & ~3;
+  memset(out, 0, padded);
+  memcpy(out, s, length);
+  return(padded);
+}
+
+// format the address and type tags of a kind of message on a port, where 
+//  the default port has no name in the address
+static void make_template(int port, const char *port_name, int kind, 
+                          const char *name, const char *tags) {
+  char address[OSC_HEADER_SIZE];
+  OscTemplate *template = &templates[port][kind];
+  if (port == 0) snprintf(address, sizeof(address), "/joy2midi/%s", name);
+  else snprintf(address, sizeof(address), "/joy2midi/%s/%s", port_name, name);
+  template->header_size = put_string(template->header, address);
+  template->header_size += 
+    put_string(template->header + template->header_size, tags);
+  template->args = strlen(tags) - 1;
+}
+
+// get the monotonic time in nanoseconds of a frame near the present
+static int64_t frame_monotonic(uint32_t frame) {
+  int64_t now = monotonic_frames();
+  int64_t frames = now + (int32_t)(frame - (uint32_t)now);
+  return(((frames / OSC_RATE) * 1000000000) + 
+    (((frames % OSC_RATE) * 1000000000) / OSC_RATE));
+}
+
+// convert monotonic nanoseconds to an OSC timetag
+static uint64_t timetag(int64_t monotonic) {
+  int64_t wall = monotonic + wall_offset;
+  uint64_t seconds = (wall / 1000000000) + OSC_EPOCH_OFFSET;
+  uint64_t fraction = ((uint64_t)(wall % 1000000000) << 32) / 1000000000;
+  return((seconds << 32) | fraction);
+}
+
+// add a message to the bundle for the current period, with the context 
+//  being the templates for its port
+static int osc_write(void *context, int32_t time, 
+                     const uint8_t *data, size_t size) {
+  OscTemplate *port_templates = (OscTemplate *)context;
+  int32_t args[OSC_MAX_ARGS];
+  int i, kind;
+  uint8_t status = data[0] & 0xF0;
+  int channel = (data[0] & 0x0F) + 1;
+  if ((status == 0x90) || (status == 0x80)) {
+    kind = OSC_NOTE;
+    args[0] = channel;
+    args[1] = data[1];
+    args[2] = (status == 0x90) ? data[2] : 0;
+  }
+  else if (status == 0xB0) {
+    kind = OSC_CONTROL;
+    args[0] = channel;
+    args[1] = data[1];
+    args[2] = data[2];
+  }
+  else if (status == 0xE0) {
+    kind = OSC_BEND;
+    args[0] = channel;
+    args[1] = (data[2] << 7) | data[1];
+  }
+  // nothing else gets mapped, so there's nothing to send
+  else return(1);
+  const OscTemplate *template = &port_templates[kind];
+  size_t message_size = template->header_size + (template->args * 4);
+  if (packet_size + 4 + message_size > sizeof(packet)) return(0);
+  // stamp the bundle with the time of its earliest message
+  if ((first_time < 0) || (time < first_time)) first_time = time;
+  uint8_t *out = packet + packet_size;
+  put_int32(out, message_size);
+  memcpy(out + 4, template->header, template->header_size);
+  out += 4 + template->header_size;
+  for (i = 0; i < template->args; i++) {
+    put_int32(out + (i * 4), args[i]);
+  }
+  packet_size += 4 + message_size;
+  return(1);
+}
+
+// send the messages for each period as a bundle when it ends
+static void *send_thread(void *arg) {
+  struct timespec wake;
+  int port;
+  MidiSink sink = { osc_write, NULL };
+  uint32_t period_start = osc_time();
+  clock_gettime(CLOCK_MONOTONIC, &wake);
+  while (__atomic_load_n(&running, __ATOMIC_RELAXED)) {
+    // wait for the period to end
+    wake.tv_nsec += 1000000;
+    if (wake.tv_nsec >= 1000000000) {
+      wake.tv_nsec -= 1000000000;
+      wake.tv_sec++;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL);
+    // the bundle header stays in place, so only the timetag changes
+    packet_size = 16;
+    first_time = -1;
+    // messages for all ports go in the same bundle
+    output_begin_period();
+    for (port = 0; port < output_port_count(); port++) {
+      sink.context = templates[port];
+      output_process(port, &sink, period_start, OSC_PERIOD);
+    }
+    output_end_period();
+    uint32_t first_frame = period_start + first_time;
+    period_start += OSC_PERIOD;
+    if (first_time < 0) continue;
+    // stamp the bundle with the frame its first message was scheduled 
+    //  for, rather than when the period happened to be sent
+    uint64_t tag = timetag(frame_monotonic(first_frame));
+    put_int32(packet + 8, tag >> 32);
+    put_int32(packet + 12, tag);
+    while (send(socket_fd, packet, packet_size, 0) < 0) {
+      if (errno == EINTR) continue;
+      // nothing is listening yet, which is fine for UDP
+      if (errno != ECONNREFUSED) fprintf(stderr, 
+        "ERROR: Failed to send OSC to '%s'.\n", target_spec);
+      break;
+    }
+  }
+  return(NULL);
+}
+
+// open a UDP socket connected to the target, returning 0 on failure
+static int open_socket(void) {
+  char host[256];
+  const char *port = strrchr(target_spec, ':');
+  if ((port == NULL) || (port == target_spec) || 
+      ((size_t)(port - target_spec) >= sizeof(host))) {
+    fprintf(stderr, 
+      "ERROR: The OSC target '%s' should look like host:port.\n", 
+      target_spec);
+    return(0);
+  }
+  memcpy(host, target_spec, port - target_spec);
+  host[port - target_spec] = '\0';
+  port++;
+  struct addrinfo hints, *addresses, *address;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  int result = getaddrinfo(host, port, &hints, &addresses);
+  if (result != 0) {
+    fprintf(stderr, "ERROR: Failed to look up '%s': %s\n", 
+      target_spec, gai_strerror(result));
+    return(0);
+  }
+  for (address = addresses; address != NULL; address = address->ai_next) {
+    socket_fd = socket(address->ai_family, address->ai_socktype, 
+                       address->ai_protocol);
+    if (socket_fd < 0) continue;
+    if (connect(socket_fd, address->ai_addr, address->ai_addrlen) == 0) break;
+    close(socket_fd);
+    socket_fd = -1;
+  }
+  freeaddrinfo(addresses);
+  if (socket_fd < 0) {
+    fprintf(stderr, "ERROR: Failed to open a socket to '%s'.\n", 
+      target_spec);
+    return(0);
+  }
+  return(1);
+}
+
+static int osc_start(const char *const *port_names, int port_count, 
+                     int coalesce_window) {
+  int port;
+  if (! open_socket()) return(0);
+  for (port = 0; port < port_count; port++) {
+    make_template(port, port_names[port], OSC_NOTE, "note", ",iii");
+    make_template(port, port_names[port], OSC_CONTROL, "control", ",iii");
+    make_template(port, port_names[port], OSC_BEND, "bend", ",ii");
+  }
+  put_string(packet, "#bundle");
+  struct timespec wall, monotonic;
+  clock_gettime(CLOCK_REALTIME, &wall);
+  clock_gettime(CLOCK_MONOTONIC, &monotonic);
+  wall_offset = (((int64_t)wall.tv_sec - monotonic.tv_sec) * 1000000000) + 
+    (wall.tv_nsec - monotonic.tv_nsec);
+  output_init(port_count, coalesce_window, OSC_RATE);
+  running = 1;
+  if (pthread_create(&sender, NULL, send_thread, NULL) != 0) {
+    fprintf(stderr, "ERROR: Failed to start sending OSC.\n");
+    running = 0;
+    return(0);
+  }
+  return(1);
+}
+
+static int osc_priority(void) {
+  return(0);
+}
+
+static void osc_stop(void) {
+  if (__atomic_exchange_n(&running, 0, __ATOMIC_SEQ_CST)) {
+    pthread_join(sender, NULL);
+  }
+  if (socket_fd >= 0) close(socket_fd);
+  socket_fd = -1;
+}
+
+OutputBackend osc_output = { 
+  osc_start, osc_time, osc_rate, osc_priority, osc_stop };
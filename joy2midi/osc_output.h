@@ -0,0 +1,12 @@
+#ifndef JOY2MIDI_OSC_OUTPUT_H
+#define JOY2MIDI_OSC_OUTPUT_H
+
+#include "output.h"
+
+// send messages as OSC bundles over UDP
+extern OutputBackend osc_output;
+
+// set the host and port to send to, as "host:port" (call before starting)
+void osc_configure(const char *target);
+
+#endif
@@ -0,0 +1,287 @@
+#include <string.h>
+#include <time.h>
+
+#include "capture.h"
+#include "coalesce.h"
+#include "output.h"
+
+// the queue passing outgoing messages for one port to the output thread, 
+//  and the state for dropping its redundant controller messages
+typedef struct {
+  MidiRing queue;
+  Coalescer coalescer;
+} OutputPort;
+static OutputPort ports[OUTPUT_MAX_PORTS];
+static int port_count = 1;
+// counters only written by the output thread
+static uint32_t sent_events = 0;
+static uint32_t late_events = 0;
+static uint32_t spilled_events = 0;
+static uint32_t written_bytes = 0;
+static uint32_t saved_bytes = 0;
+// distributions only written by the output thread
+static OutputHistograms histograms;
+// the frames per second of the output clock, for converting latencies
+static uint32_t output_rate = 48000;
+// messages sent on all ports in the current period, in frame order, 
+//  waiting to be captured (only used by the output thread)
+static MidiEvent captured[RING_SIZE];
+static uint32_t captured_count = 0;
+// when the current period started processing (only used by the output 
+//  thread)
+static uint64_t period_started = 0;
+
+void output_init(int count, int coalesce_window, uint32_t sample_rate) {
+  int i;
+  port_count = (count < 1) ? 1 : 
+    ((count > OUTPUT_MAX_PORTS) ? OUTPUT_MAX_PORTS : count);
+  for (i = 0; i < port_count; i++) {
+    ring_init(&ports[i].queue);
+    coalesce_init(&ports[i].coalescer, coalesce_window >= 0, 
+      (coalesce_window > 0) ? 
+        ((uint32_t)coalesce_window * sample_rate) / 1000 : 0);
+  }
+  histogram_init(&histograms.latency);
+  histogram_init(&histograms.depth);
+  histogram_init(&histograms.process);
+  if (sample_rate > 0) output_rate = sample_rate;
+}
+
+int output_port_count(void) {
+  return(port_count);
+}
+
+int output_send(const MidiEvent *event) {
+  return(ring_push(&ports[event->port].queue, event));
+}
+
+int output_send_batch(const MidiEvent *events, uint32_t count) {
+  MidiEvent batch[count];
+  uint32_t batched[OUTPUT_MAX_PORTS];
+  uint32_t i, j, n;
+  int port;
+  // make sure every port has room before pushing anything, so an input 
+  //  never reaches some ports and not others; only this thread adds to 
+  //  the rings, so the room can only grow before the events are pushed
+  memset(batched, 0, sizeof(batched));
+  for (i = 0; i < count; i++) batched[events[i].port]++;
+  for (port = 0; port < OUTPUT_MAX_PORTS; port++) {
+    if (batched[port] == 0) continue;
+    if (ring_count(&ports[port].queue) + batched[port] > RING_SIZE) break;
+  }
+  if (port < OUTPUT_MAX_PORTS) {
+    for (port = 0; port < OUTPUT_MAX_PORTS; port++) {
+      if (batched[port] > 0) ring_drop(&ports[port].queue, batched[port]);
+    }
+    return(0);
+  }
+  // push the events for each port together, in the order they came
+  for (port = 0; port < OUTPUT_MAX_PORTS; port++) {
+    if (batched[port] == 0) continue;
+    n = 0;
+    for (j = 0; j < count; j++) {
+      if (events[j].port == port) batch[n++] = events[j];
+    }
+    ring_push_batch(&ports[port].queue, batch, n);
+  }
+  return(1);
+}
+
+uint32_t output_pending(void) {
+  uint32_t pending = 0;
+  int i;
+  for (i = 0; i < port_count; i++) pending += ring_count(&ports[i].queue);
+  return(pending);
+}
+
+void output_count_bytes(uint32_t written, uint32_t saved) {
+  __atomic_store_n(&written_bytes, written_bytes + written, __ATOMIC_RELAXED);
+  __atomic_store_n(&saved_bytes, saved_bytes + saved, __ATOMIC_RELAXED);
+}
+
+void output_get_stats(OutputStats *stats) {
+  int i;
+  stats->sent = __atomic_load_n(&sent_events, __ATOMIC_RELAXED);
+  stats->late = __atomic_load_n(&late_events, __ATOMIC_RELAXED);
+  stats->spilled = __atomic_load_n(&spilled_events, __ATOMIC_RELAXED);
+  stats->bytes = __atomic_load_n(&written_bytes, __ATOMIC_RELAXED);
+  stats->bytes_saved = __atomic_load_n(&saved_bytes, __ATOMIC_RELAXED);
+  stats->dropped = stats->continuous = stats->coalesced = 0;
+  stats->high_water = 0;
+  for (i = 0; i < port_count; i++) {
+    OutputPort *port = &ports[i];
+    stats->dropped += ring_dropped(&port->queue);
+    stats->continuous += 
+      __atomic_load_n(&port->coalescer.continuous, __ATOMIC_RELAXED);
+    stats->coalesced += 
+      __atomic_load_n(&port->coalescer.coalesced, __ATOMIC_RELAXED);
+    uint32_t high_water = ring_high_water(&port->queue);
+    if (high_water > stats->high_water) stats->high_water = high_water;
+  }
+}
+
+void output_get_histograms(OutputHistograms *snapshot) {
+  histogram_read(&histograms.latency, &snapshot->latency);
+  histogram_read(&histograms.depth, &snapshot->depth);
+  histogram_read(&histograms.process, &snapshot->process);
+}
+
+// get the current time in nanoseconds for measuring processing
+static uint64_t process_clock(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return(((uint64_t)now.tv_sec * 1000000000) + now.tv_nsec);
+}
+
+// pass the messages sent so far in the period to the capture
+static void flush_captured(void) {
+  uint32_t i;
+  for (i = 0; i < captured_count; i++) {
+    capture_message(captured[i].time, captured[i].data, captured[i].size);
+  }
+  captured_count = 0;
+}
+
+// hold a sent message for the capture, after any others at the same frame 
+//  so ports are merged without reordering any of them
+static void capture_sent(uint32_t frame, const uint8_t *data, int size) {
+  uint32_t i;
+  if (! capture_active()) return;
+  if (captured_count >= RING_SIZE) flush_captured();
+  for (i = captured_count; i > 0; i--) {
+    if ((int32_t)(frame - captured[i - 1].time) >= 0) break;
+  }
+  memmove(&captured[i + 1], &captured[i], 
+    (captured_count - i) * sizeof(MidiEvent));
+  captured[i].time = frame;
+  captured[i].size = size;
+  memcpy(captured[i].data, data, size);
+  captured_count++;
+}
+
+// record how long after its input an event was scheduled to go out
+static void record_latency(uint32_t frame, const MidiEvent *event) {
+  int32_t frames = (int32_t)(frame - event->time);
+  if (frames < 0) frames = 0;
+  histogram_record(&histograms.latency, 
+    ((uint64_t)frames * 1000000) / output_rate);
+}
+
+// write as much of an event to the sink as it has room for, keeping the 
+//  messages in order at or after their scheduled frame, and return 1 if 
+//  it was all written or leave just the unwritten messages in the event 
+//  and return 0 if the sink filled up
+static int write_event(MidiSink *sink, uint32_t period_start, int32_t time, 
+                       int32_t *last_time, MidiEvent *event) {
+  int size, offset = 0;
+  // several messages can go out at the same frame, but never before one 
+  //  that was sent ahead of them
+  if (time < *last_time) time = *last_time;
+  while (offset < event->size) {
+    size = midi_message_size(event->data[offset]);
+    if (offset + size > event->size) break;
+    if (! sink->write(sink->context, time, event->data + offset, size)) {
+      memmove(event->data, event->data + offset, event->size - offset);
+      event->size -= offset;
+      return(0);
+    }
+    capture_sent(period_start + time, event->data + offset, size);
+    offset += size;
+  }
+  *last_time = time;
+  record_latency(period_start + time, event);
+  __atomic_store_n(&sent_events, sent_events + 1, __ATOMIC_RELAXED);
+  return(1);
+}
+
+// count an event that was left for the next period, unless it was already 
+//  left over from an earlier one
+static void spill(MidiEvent *event) {
+  if (event->spilled) return;
+  event->spilled = 1;
+  __atomic_store_n(&spilled_events, spilled_events + 1, __ATOMIC_RELAXED);
+}
+
+void output_begin_period(void) {
+  period_started = process_clock();
+  captured_count = 0;
+}
+
+void output_end_period(void) {
+  flush_captured();
+  histogram_record(&histograms.process, process_clock() - period_started);
+}
+
+void output_process(int port, MidiSink *sink, 
+                    uint32_t period_start, uint32_t nframes) {
+  // messages and their scheduled frames for the period (only used here)
+  static MidiEvent *pending[RING_SIZE];
+  static uint32_t pending_times[RING_SIZE];
+  static DueEvent due[COALESCE_MAX_DUE];
+  uint32_t i, count = 0;
+  int due_count, next_due = 0;
+  int32_t last_message_time = 0;
+  int32_t time = 0;
+  int full = 0;
+  MidiRing *queue = &ports[port].queue;
+  Coalescer *coalescer = &ports[port].coalescer;
+  histogram_record(&histograms.depth, ring_count(queue));
+  // find queued messages that fall in this period
+  MidiEvent *event;
+  while ((event = ring_peek_at(queue, count)) != NULL) {
+    // send each message one period after its input happened so that 
+    //  messages keep their spacing within the period
+    time = (int32_t)(event->time + nframes - period_start);
+    if (time >= (int32_t)nframes) break;
+    pending[count] = event;
+    pending_times[count] = event->time + nframes;
+    count++;
+  }
+  // drop redundant controller messages
+  due_count = coalesce_due(coalescer, period_start, nframes, due);
+  coalesce_period(coalescer, pending, pending_times, count);
+  // send messages
+  for (i = 0; i < count; i++) {
+    event = pending[i];
+    time = (int32_t)(pending_times[i] - period_start);
+    // messages that should already have gone out go as soon as possible, 
+    //  and only count as late if it isn't because they were spilled
+    if (time < 0) {
+      if (! event->spilled) 
+        __atomic_store_n(&late_events, late_events + 1, __ATOMIC_RELAXED);
+      time = 0;
+    }
+    // send held messages that come due first
+    while ((! full) && (next_due < due_count) && (due[next_due].time <= time)) {
+      if (write_event(sink, period_start, due[next_due].time, 
+                      &last_message_time, &due[next_due].event)) next_due++;
+      else full = 1;
+    }
+    // skip messages that were coalesced
+    if (event->size == 0) {
+      ring_pop(queue);
+      continue;
+    }
+    // leave the rest of the messages for the next period, in order, once 
+    //  the sink has no more room
+    if ((full) || 
+        (! write_event(sink, period_start, time, &last_message_time, event))) {
+      full = 1;
+      for (; i < count; i++) {
+        if (pending[i]->size > 0) spill(pending[i]);
+      }
+      break;
+    }
+    ring_pop(queue);
+  }
+  // send any held messages that are still due, or hold them for the next 
+  //  period if there's no room left
+  for (; next_due < due_count; next_due++) {
+    if ((! full) && (write_event(sink, period_start, due[next_due].time, 
+                                 &last_message_time, &due[next_due].event))) 
+      continue;
+    full = 1;
+    spill(&due[next_due].event);
+    coalesce_hold(coalescer, &due[next_due].event, period_start + nframes);
+  }
+}
@@ -0,0 +1,108 @@
+#ifndef JOY2MIDI_OUTPUT_H
+#define JOY2MIDI_OUTPUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "histogram.h"
+#include "ring.h"
+
+// the most output ports there can be
+#define OUTPUT_MAX_PORTS 16
+// the most characters in the name of an output port
+#define OUTPUT_MAX_PORT_NAME 32
+// the name of the port that's always there, which mappings send to unless 
+//  they name another one
+#define OUTPUT_DEFAULT_PORT "out"
+
+// a destination for the messages sent in one processing period
+typedef struct {
+  // write a message at a frame offset within the period, returning 0 if 
+  //  there's no room for it
+  int (*write)(void *context, int32_t time, const uint8_t *data, size_t size);
+  void *context;
+} MidiSink;
+
+// a way of getting MIDI out of the program
+typedef struct {
+  // set up output ports with the given names and coalescing window (see 
+  //  output_init) and start sending, returning 0 on failure
+  int (*start)(const char *const *port_names, int port_count, 
+               int coalesce_window);
+  // get the current time on the output's frame clock
+  uint32_t (*frame_time)(void);
+  // get the number of frames per second on the output's frame clock
+  uint32_t (*sample_rate)(void);
+  // get the real-time priority of the thread that sends, or 0 if it 
+  //  doesn't run in real time
+  int (*priority)(void);
+  // stop sending
+  void (*stop)(void);
+} OutputBackend;
+
+// counters for what happened to outgoing messages
+typedef struct {
+  // messages sent to the sink
+  uint32_t sent;
+  // messages that arrived too late to keep their timing
+  uint32_t late;
+  // messages left for the next period because the sink was full
+  uint32_t spilled;
+  // messages that didn't fit in the queue
+  uint32_t dropped;
+  // controller and bend messages that came in
+  uint32_t continuous;
+  // controller and bend messages dropped by coalescing
+  uint32_t coalesced;
+  // bytes written to a byte-stream sink
+  uint32_t bytes;
+  // bytes left out of a byte stream by using running status
+  uint32_t bytes_saved;
+  // the most messages that were ever waiting in one port's queue
+  uint32_t high_water;
+} OutputStats;
+
+// distributions of how the output is performing
+typedef struct {
+  // microseconds from when an input happened to the frame its first 
+  //  message was scheduled at
+  Histogram latency;
+  // messages waiting in a port's queue at the start of each period
+  Histogram depth;
+  // nanoseconds spent processing each period
+  Histogram process;
+} OutputHistograms;
+
+// set up a queue for each output port with a window in milliseconds to 
+//  coalesce controller messages over, with 0 meaning one period and a 
+//  negative number turning coalescing off (not thread-safe)
+void output_init(int port_count, int coalesce_window, uint32_t sample_rate);
+// get the number of output ports
+int output_port_count(void);
+// queue a message on its port from the reader thread, returning 0 if it 
+//  was dropped
+int output_send(const MidiEvent *event);
+// queue messages produced by one input so the output thread sees all the 
+//  ones for each port at once, or drop all of them and return 0 if any 
+//  port's queue doesn't have room for its share (reader thread only)
+int output_send_batch(const MidiEvent *events, uint32_t count);
+// start and finish a processing period around the calls to output_process 
+//  for each port, so the messages all ports send in it can be handled 
+//  together and the period is timed once (output thread only)
+void output_begin_period(void);
+void output_end_period(void);
+// send the messages queued on a port that fall in a processing period to 
+//  a sink, which never blocks or allocates (output thread only)
+void output_process(int port, MidiSink *sink, 
+                    uint32_t period_start, uint32_t nframes);
+// get the number of messages waiting to be sent on all ports
+uint32_t output_pending(void);
+// count bytes written to a byte-stream sink and bytes left out of it 
+//  (output thread only)
+void output_count_bytes(uint32_t written, uint32_t saved);
+// get a snapshot of the output counters
+void output_get_stats(OutputStats *stats);
+// get a snapshot of the output histograms
+void output_get_histograms(OutputHistograms *histograms);
+
+#endif
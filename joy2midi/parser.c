@@ -8,42 +8,74 @@ void yyerror(char const *);
 typedef union YYSTYPE YYSTYPE;
 union YYSTYPE {
   int NUM;
+  double DECIMAL;
   int type;
   MapSpec spec;
+  MapOptions options;
+  Curve curve;
+  char *string;
 };
 # define YYSTYPE_IS_DECLARED 1
-// enable use of the undocumented yytoknum array for mapping keywords
-static void print_token_value(FILE *, int, YYSTYPE);
-#define YYPRINT(stream, token, value) \
-  print_token_value(stream, token, value)
   
 %}
 
 %define parse.trace
 %define parse.error verbose
-%define api.value.type union
 
 // a sequence of digits
-%token <int> NUM
+%token <NUM> NUM
+// digits with a decimal point and a fractional part
+%token <DECIMAL> DECIMAL
+// text in double quotes
+%token <string> STRING
+// free strings the parser throws away when it recovers from or gives up 
+//  on a syntax error, since only the actions that use them take ownership
+%destructor { free($$); } <string>
 // a number that can be positive or negative
-%type  <int> number
+%type  <NUM> number
+// a number that can have a fractional part
+%type  <DECIMAL> decimal
 // event types
-%token <int> AXIS "axis"
-%token <int> BUTTON "button"
-%token <int> NOTE "note"
-%token <int> CONTROL "control"
-%token <int> BEND "bend"
-%token <int> IGNORE "ignore"
+%token <type> AXIS "axis"
+%token <type> BUTTON "button"
+%token <type> NOTE "note"
+%token <type> CONTROL "control"
+%token <type> CONTROL14 "control14"
+%token <type> NRPN "nrpn"
+%token <type> BEND "bend"
+%token <type> IGNORE "ignore"
 // parameters
-%token <int> VERBOSITY "verbosity"
-%token <int> DEBOUNCE "debounce"
-%token <int> CHANNEL "channel"
+%token <type> VERBOSITY "verbosity"
+%token <type> DEBOUNCE "debounce"
+%token <type> CHANNEL "channel"
+%token <type> TABLES "tables"
+%token <type> COALESCE "coalesce"
+%token <type> PORT "port"
+// sections
+%token <type> DEVICE "device"
+// response curves
+%token <type> CURVE "curve"
+%token <type> LINEAR "linear"
+%token <type> EXPONENTIAL "exp"
+%token <type> SCURVE "scurve"
+// input filters
+%token <type> SMOOTH "smooth"
+%token <type> DEADBAND "deadband"
+%token <type> INTERVAL "interval"
 // groupings
-%type <MapSpec>	inspec
-%type <MapSpec> outspec
-%type <int>	joytype
-%type <int>	miditype
-%token-table
+%type <spec> inspec
+%type <spec> outspec
+%type <type> joytype
+%type <type> miditype
+%type <spec> widespec
+%type <type> widetype
+%type <options> options
+%type <curve> curve
+%type <curve> points
+// show values when tracing
+%printer { fprintf(yyo, "%d", $$); } <NUM>
+%printer { fprintf(yyo, "%g", $$); } <DECIMAL>
+%printer { fprintf(yyo, "[%d]", $$); } <type>
 
 %% // grammar rules and actions
 
@@ -55,6 +87,7 @@ map:
 line:
   '\n'
 | parameter '\n'
+| section '\n'
 | mapping '\n'
 ;
 
@@ -63,14 +96,30 @@ number:
 | '-' NUM { $$ = - $2; }
 ;
 
+decimal:
+  NUM     { $$ = $1; }
+| DECIMAL { $$ = $1; }
+;
+
 parameter:
-  VERBOSITY '=' number { verbosity = $3; }
-| DEBOUNCE '=' number  { debounce = $3; }
-| CHANNEL '=' number { channel = (($3 - 1) & 0xF); }
+  VERBOSITY '=' number { loading_config->verbosity = $3; }
+| DEBOUNCE '=' number  { loading_config->debounce.press = $3; }
+| DEBOUNCE '=' number number {
+    loading_config->debounce.press = $3;
+    loading_config->debounce.release = $4;
+  }
+| CHANNEL '=' number { loading_config->channel = (($3 - 1) & 0xF); }
+| TABLES '=' number { loading_config->use_tables = $3; }
+| COALESCE '=' number { loading_config->coalesce_window = $3; }
+| PORT STRING { declare_port($2); }
+;
+
+section:
+  DEVICE STRING { begin_section($2); }
 ;
 
 mapping:
-  inspec '=' '>' outspec { add_mapping($1, $4); }
+  inspec '=' '>' outspec options { add_mapping($1, $4, $5); }
 ;
 
 inspec:
@@ -122,6 +171,21 @@ outspec:
     $$.min = $3;
     $$.max = $6;
   }
+| widespec {
+    $$ = $1;
+    $$.min = 0;
+    $$.max = 0x3FFF;
+  }
+| widespec '[' NUM ']' {
+    $$ = $1;
+    $$.min = $3;
+    $$.max = $3;
+  }
+| widespec '[' NUM '.' '.' NUM ']' {
+    $$ = $1;
+    $$.min = $3;
+    $$.max = $6;
+  }
 | miditype NUM {
     $$.type = $1;
     $$.number = $2;
@@ -147,35 +211,203 @@ miditype:
 | CONTROL
 ;
 
+widespec:
+  widetype NUM {
+    $$.type = $1;
+    $$.number = $2;
+    if (($1 == CONTROL14) && ($2 > 31)) {
+      yyerror("14-bit controllers are numbered from 0 to 31");
+    }
+    else if ($2 > 0x3FFF) {
+      yyerror("NRPNs are numbered from 0 to 16383");
+    }
+  }
+;
+
+widetype:
+  CONTROL14
+| NRPN
+;
+
+options:
+  %empty { $$ = default_map_options(); }
+| options CURVE curve {
+    $$ = $1;
+    $$.curve = $3;
+  }
+| options SMOOTH {
+    $$ = $1;
+    $$.filter.cutoff = FILTER_DEFAULT_CUTOFF;
+    $$.filter.beta = FILTER_DEFAULT_BETA;
+  }
+| options SMOOTH decimal {
+    $$ = $1;
+    $$.filter.cutoff = $3;
+    $$.filter.beta = FILTER_DEFAULT_BETA;
+  }
+| options SMOOTH decimal NUM {
+    $$ = $1;
+    $$.filter.cutoff = $3;
+    $$.filter.beta = $4;
+  }
+| options DEADBAND NUM {
+    $$ = $1;
+    $$.filter.deadband = $3;
+  }
+| options INTERVAL NUM {
+    $$ = $1;
+    $$.filter.interval = $3;
+  }
+| options PORT STRING {
+    $$ = $1;
+    $$.port = find_port($3);
+  }
+| options CHANNEL NUM {
+    $$ = $1;
+    if (($3 < 1) || ($3 > 16)) {
+      yyerror("channels are numbered from 1 to 16");
+    }
+    $$.channel = ($3 - 1) & 0xF;
+  }
+;
+
+curve:
+  LINEAR { $$.type = CURVE_LINEAR; }
+| EXPONENTIAL {
+    $$.type = CURVE_EXPONENTIAL;
+    $$.steepness = CURVE_DEFAULT_EXPONENTIAL;
+  }
+| EXPONENTIAL number {
+    $$.type = CURVE_EXPONENTIAL;
+    $$.steepness = $2;
+  }
+| SCURVE {
+    $$.type = CURVE_S;
+    $$.steepness = CURVE_DEFAULT_S;
+  }
+| SCURVE NUM {
+    $$.type = CURVE_S;
+    $$.steepness = $2;
+  }
+| '[' points ']' { $$ = $2; }
+;
+
+points:
+  NUM ':' NUM {
+    $$.type = CURVE_POINTS;
+    $$.count = 1;
+    $$.x[0] = $1;
+    $$.y[0] = $3;
+  }
+| points ',' NUM ':' NUM {
+    $$ = $1;
+    if ($$.count >= CURVE_MAX_POINTS) {
+      yyerror("too many points in curve");
+    }
+    else if ($3 < $$.x[$$.count - 1]) {
+      yyerror("curve points must be in order of input");
+    }
+    else {
+      $$.x[$$.count] = $3;
+      $$.y[$$.count] = $5;
+      $$.count++;
+    }
+  }
+;
+
 %%
 
-// parse the map file
-void parse_map() {
+// where the lexer is in the map file text
+static size_t lex_position = 0;
+// where the line the lexer is on starts
+static size_t line_start = 0;
+// where the line the last token started on starts, for showing errors
+static size_t token_line_start = 0;
+
+// parse the map file, returning the number of errors
+int parse_map() {
   // initialize the location structure
   yylloc.first_line = yylloc.last_line = 1;
   yylloc.first_column = yylloc.last_column = 0;
+  lex_position = line_start = token_line_start = 0;
   // parse
-  yyparse();
+  parse_errors = 0;
+  if ((yyparse() != 0) && (parse_errors == 0)) parse_errors++;
+  return(parse_errors);
 }
 
-// get the next character from the map file
-unsigned char nextchar() {
+// get the next character from the map file without consuming it, which is 
+//  a null character at the end of the file
+static unsigned char peekchar(void) {
+  return((lex_position < map_length) ? map_text[lex_position] : 0);
+}
+
+// consume the next character from the map file
+static unsigned char nextchar(void) {
+  unsigned char c = peekchar();
   ++yylloc.last_column;
-  // check for the end of the file so we don't keep reading
-  int c = fgetc(map_file);
-  if (c < 0) c = 0;
+  if (lex_position < map_length) lex_position++;
   return(c);
 }
-// backtrack in the map file by the given number of characters
-void backtrack(int count) {
+
+// give back characters the lexer consumed
+static void unread(size_t count) {
+  lex_position -= count;
   yylloc.last_column -= count;
-  fseek(map_file, - count, SEEK_CUR);
+}
+
+// keywords recognized by the lexer and the tokens they produce, arranged 
+//  so that keyword_hash gives each one a different slot (if you add one, 
+//  check there are still no collisions and adjust the hash if there are)
+#define KEYWORD_SLOTS 64
+#define KEYWORD_MIN_LENGTH 3
+#define KEYWORD_MAX_LENGTH 9
+static const struct {
+  const char *name;
+  int token;
+} keywords[KEYWORD_SLOTS] = {
+  [3] = { "axis", AXIS },
+  [4] = { "coalesce", COALESCE },
+  [8] = { "curve", CURVE },
+  [10] = { "interval", INTERVAL },
+  [12] = { "scurve", SCURVE },
+  [14] = { "device", DEVICE },
+  [16] = { "ignore", IGNORE },
+  [24] = { "tables", TABLES },
+  [25] = { "smooth", SMOOTH },
+  [31] = { "linear", LINEAR },
+  [33] = { "bend", BEND },
+  [36] = { "verbosity", VERBOSITY },
+  [39] = { "button", BUTTON },
+  [41] = { "control14", CONTROL14 },
+  [42] = { "exp", EXPONENTIAL },
+  [44] = { "note", NOTE },
+  [46] = { "channel", CHANNEL },
+  [53] = { "control", CONTROL },
+  [56] = { "nrpn", NRPN },
+  [57] = { "deadband", DEADBAND },
+  [58] = { "debounce", DEBOUNCE },
+  [59] = { "port", PORT }
+};
+
+// get the slot a word would have in the keyword table
+static unsigned int keyword_hash(const char *word, size_t length) {
+  return(((unsigned char)word[1] + (unsigned char)word[length - 1] + 
+          (22 * length)) & (KEYWORD_SLOTS - 1));
+}
+
+// get the token for a keyword, or 0 if the word isn't one
+static int keyword_token(const char *word, size_t length) {
+  if ((length < KEYWORD_MIN_LENGTH) || (length > KEYWORD_MAX_LENGTH)) 
+    return(0);
+  unsigned int slot = keyword_hash(word, length);
+  const char *name = keywords[slot].name;
+  if ((name == NULL) || (strlen(name) != length) || 
+      (memcmp(name, word, length) != 0)) return(0);
+  return(keywords[slot].token);
 }
 
 int yylex(void) {
-  int i, kwlen;
-  char kwbuf[16];
-  char kwc;
   unsigned char c = nextchar();
   // ignore whitespace
   while ((c == ' ') || (c == '\t')) {
@@ -190,45 +422,68 @@ int yylex(void) {
   // record the start position of the token
   yylloc.first_line = yylloc.last_line;
   yylloc.first_column = yylloc.last_column;
+  token_line_start = line_start;
   // parse numbers
   if (isdigit(c)) {
-    yylval.NUM = 0;
-    while (isdigit(c)) {
-      yylval.NUM = (yylval.NUM * 10) + (c - '0');
-      c = nextchar();
+    int whole = c - '0';
+    while (isdigit(peekchar())) {
+      whole = (whole * 10) + (nextchar() - '0');
     }
-    backtrack(1);
+    // a decimal point followed by a digit starts a fractional part, which 
+    //  keeps ranges like [0..5] from looking like one
+    if ((peekchar() == '.') && (lex_position + 1 < map_length) && 
+        (isdigit(map_text[lex_position + 1]))) {
+      double scale = 1.0;
+      yylval.DECIMAL = whole;
+      nextchar();
+      while (isdigit(peekchar())) {
+        scale /= 10.0;
+        yylval.DECIMAL += scale * (nextchar() - '0');
+      }
+      return(DECIMAL);
+    }
+    yylval.NUM = whole;
     return(NUM);
   }
+  // parse quoted strings
+  if (c == '"') {
+    const char *start = map_text + lex_position;
+    while ((peekchar() != '"') && (peekchar() != '\n') && (peekchar() != 0)) {
+      nextchar();
+    }
+    yylval.string = strndup(start, (map_text + lex_position) - start);
+    // consume the closing quote, leaving an unterminated string's line 
+    //  ending to end the line
+    if (peekchar() == '"') nextchar();
+    return(STRING);
+  }
   // parse keywords
   if (isalpha(c)) {
-    kwbuf[0] = c;
-    i = 0;
-    for (i = 1; i < 15; i++) {
-      kwc = nextchar();
-      kwbuf[i] = kwc;
-      if (! isalpha(kwc)) {
-        backtrack(1);
-        break;
-      }
+    const char *word = map_text + lex_position - 1;
+    size_t length = 1, letters = 1;
+    while (isalnum(peekchar())) {
+      if ((letters == length) && (isalpha(peekchar()))) letters++;
+      nextchar();
+      length++;
     }
-    kwbuf[i] = '\0';
-    kwlen = i;
-    for (i = 0; i < YYNTOKENS; i++) {
-      if ((yytname[i] != 0) && (yytname[i][0] == '"') && 
-          (! strncmp(yytname[i] + 1, kwbuf, kwlen)) &&
-          (yytname[i][kwlen + 1] == '"') &&
-          (yytname[i][kwlen + 2] == '\0')) {
-        yylval.type = yytoknum[i];
-        return(yytoknum[i]);
-      }
+    // keywords can end in digits, but a number can also follow a keyword 
+    //  directly, as in "axis0", so try just the letters too
+    int token = keyword_token(word, length);
+    if ((token == 0) && (letters < length)) {
+      token = keyword_token(word, letters);
+      if (token != 0) unread(length - letters);
     }
-    backtrack(kwlen);
+    if (token != 0) {
+      yylval.type = token;
+      return(token);
+    }
+    unread(length - 1);
   }
   // advance the line counter
   if (c == '\n') {
     ++yylloc.last_line;
     yylloc.last_column = 0;
+    line_start = lex_position;
   }
   // all other characters are single-character tokens
   return(c);
@@ -236,38 +491,19 @@ int yylex(void) {
 
 void yyerror(char const *s) {
   int i;
+  parse_errors++;
   // write the error message
   fprintf(stderr, "ERROR: in %s line %d: %s\n", map_path, yylloc.first_line, s);
   // write the relevant line of the file to the console for reference,
   //  just like GCC does it
-  char linebuf[1024];
-  fseek(map_file, 0, SEEK_SET);
-  int c = 0;
-  int line = 1;
-  while ((c >= 0) && (line < yylloc.first_line)) {
-    c = fgetc(map_file);
-    if (c == '\n') line++;
-  }
-  if (line == yylloc.first_line) {
-    for (i = 0; i < sizeof(linebuf); i++) {
-      c = fgetc(map_file);
-      if (c == '\n') {
-        linebuf[i] = '\0';
-        break;
-      }
-      linebuf[i] = c;
-    }
-    if ((i < sizeof(linebuf)) && (i >= yylloc.first_column)) {
-      fprintf(stderr, "%s\n", linebuf);
-      for (i = 0; i < (yylloc.first_column - 1); i++) {
-        fprintf(stderr, " ");
-      }
-      fprintf(stderr, "^\n");
+  const char *line = map_text + token_line_start;
+  const char *end = memchr(line, '\n', map_length - token_line_start);
+  int length = (end != NULL) ? end - line : map_length - token_line_start;
+  if (length >= yylloc.first_column) {
+    fprintf(stderr, "%.*s\n", length, line);
+    for (i = 0; i < (yylloc.first_column - 1); i++) {
+      fprintf(stderr, " ");
     }
+    fprintf(stderr, "^\n");
   }
 }
-
-static void print_token_value (FILE *file, int type, YYSTYPE value) {
-  if (type == NUM) fprintf(file, "%d", value.NUM);
-  else fprintf(file, "[%d]", type);
-}
@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.2.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2013 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.0.2"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -61,8 +66,8 @@
 
 
 
-/* Copy the first part of user declarations.  */
-#line 3 "parser.c" /* yacc.c:339  */
+/* First part of user prologue.  */
+#line 3 "parser.c"
 
 // forward declarations for bison
 int yylex(void);
@@ -71,34 +76,39 @@ void yyerror(char const *);
 typedef union YYSTYPE YYSTYPE;
 union YYSTYPE {
   int NUM;
+  double DECIMAL;
   int type;
   MapSpec spec;
+  MapOptions options;
+  Curve curve;
+  char *string;
 };
 # define YYSTYPE_IS_DECLARED 1
-// enable use of the undocumented yytoknum array for mapping keywords
-static void print_token_value(FILE *, int, YYSTYPE);
-#define YYPRINT(stream, token, value) \
-  print_token_value(stream, token, value)
   
 
-#line 85 "parser.tab.c" /* yacc.c:339  */
+#line 90 "parser.tab.c"
 
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
 # ifndef YY_NULLPTR
-#  if defined __cplusplus && 201103L <= __cplusplus
-#   define YY_NULLPTR nullptr
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
 #  else
-#   define YY_NULLPTR 0
+#   define YY_NULLPTR ((void*)0)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 1
-#endif
-
 
 /* Debug traces.  */
 #ifndef YYDEBUG
@@ -108,65 +118,45 @@ static void print_token_value(FILE *, int, YYSTYPE);
 extern int yydebug;
 #endif
 
-/* Token type.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
   enum yytokentype
   {
-    NUM = 258,
-    AXIS = 259,
-    BUTTON = 260,
-    NOTE = 261,
-    CONTROL = 262,
-    BEND = 263,
-    IGNORE = 264,
-    VERBOSITY = 265,
-    DEBOUNCE = 266,
-    CHANNEL = 267
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    NUM = 258,                     /* NUM  */
+    DECIMAL = 259,                 /* DECIMAL  */
+    STRING = 260,                  /* STRING  */
+    AXIS = 261,                    /* "axis"  */
+    BUTTON = 262,                  /* "button"  */
+    NOTE = 263,                    /* "note"  */
+    CONTROL = 264,                 /* "control"  */
+    CONTROL14 = 265,               /* "control14"  */
+    NRPN = 266,                    /* "nrpn"  */
+    BEND = 267,                    /* "bend"  */
+    IGNORE = 268,                  /* "ignore"  */
+    VERBOSITY = 269,               /* "verbosity"  */
+    DEBOUNCE = 270,                /* "debounce"  */
+    CHANNEL = 271,                 /* "channel"  */
+    TABLES = 272,                  /* "tables"  */
+    COALESCE = 273,                /* "coalesce"  */
+    PORT = 274,                    /* "port"  */
+    DEVICE = 275,                  /* "device"  */
+    CURVE = 276,                   /* "curve"  */
+    LINEAR = 277,                  /* "linear"  */
+    EXPONENTIAL = 278,             /* "exp"  */
+    SCURVE = 279,                  /* "scurve"  */
+    SMOOTH = 280,                  /* "smooth"  */
+    DEADBAND = 281,                /* "deadband"  */
+    INTERVAL = 282                 /* "interval"  */
   };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
 
 /* Value type.  */
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE YYSTYPE;
-union YYSTYPE
-{
-
-#line 136 "parser.tab.c" /* yacc.c:355  */
-  /* inspec  */
-  MapSpec inspec;
-  /* outspec  */
-  MapSpec outspec;
-  /* NUM  */
-  int NUM;
-  /* "axis"  */
-  int AXIS;
-  /* "button"  */
-  int BUTTON;
-  /* "note"  */
-  int NOTE;
-  /* "control"  */
-  int CONTROL;
-  /* "bend"  */
-  int BEND;
-  /* "ignore"  */
-  int IGNORE;
-  /* "verbosity"  */
-  int VERBOSITY;
-  /* "debounce"  */
-  int DEBOUNCE;
-  /* "channel"  */
-  int CHANNEL;
-  /* number  */
-  int number;
-  /* joytype  */
-  int joytype;
-  /* miditype  */
-  int miditype;
-};
-# define YYSTYPE_IS_TRIVIAL 1
-# define YYSTYPE_IS_DECLARED 1
-#endif
 
 /* Location type.  */
 #if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
@@ -185,40 +175,160 @@ struct YYLTYPE
 
 extern YYSTYPE yylval;
 extern YYLTYPE yylloc;
+
 int yyparse (void);
 
 
 
-/* Copy the second part of user declarations.  */
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_NUM = 3,                        /* NUM  */
+  YYSYMBOL_DECIMAL = 4,                    /* DECIMAL  */
+  YYSYMBOL_STRING = 5,                     /* STRING  */
+  YYSYMBOL_AXIS = 6,                       /* "axis"  */
+  YYSYMBOL_BUTTON = 7,                     /* "button"  */
+  YYSYMBOL_NOTE = 8,                       /* "note"  */
+  YYSYMBOL_CONTROL = 9,                    /* "control"  */
+  YYSYMBOL_CONTROL14 = 10,                 /* "control14"  */
+  YYSYMBOL_NRPN = 11,                      /* "nrpn"  */
+  YYSYMBOL_BEND = 12,                      /* "bend"  */
+  YYSYMBOL_IGNORE = 13,                    /* "ignore"  */
+  YYSYMBOL_VERBOSITY = 14,                 /* "verbosity"  */
+  YYSYMBOL_DEBOUNCE = 15,                  /* "debounce"  */
+  YYSYMBOL_CHANNEL = 16,                   /* "channel"  */
+  YYSYMBOL_TABLES = 17,                    /* "tables"  */
+  YYSYMBOL_COALESCE = 18,                  /* "coalesce"  */
+  YYSYMBOL_PORT = 19,                      /* "port"  */
+  YYSYMBOL_DEVICE = 20,                    /* "device"  */
+  YYSYMBOL_CURVE = 21,                     /* "curve"  */
+  YYSYMBOL_LINEAR = 22,                    /* "linear"  */
+  YYSYMBOL_EXPONENTIAL = 23,               /* "exp"  */
+  YYSYMBOL_SCURVE = 24,                    /* "scurve"  */
+  YYSYMBOL_SMOOTH = 25,                    /* "smooth"  */
+  YYSYMBOL_DEADBAND = 26,                  /* "deadband"  */
+  YYSYMBOL_INTERVAL = 27,                  /* "interval"  */
+  YYSYMBOL_28_n_ = 28,                     /* '\n'  */
+  YYSYMBOL_29_ = 29,                       /* '-'  */
+  YYSYMBOL_30_ = 30,                       /* '='  */
+  YYSYMBOL_31_ = 31,                       /* '>'  */
+  YYSYMBOL_32_ = 32,                       /* '['  */
+  YYSYMBOL_33_ = 33,                       /* ']'  */
+  YYSYMBOL_34_ = 34,                       /* '.'  */
+  YYSYMBOL_35_ = 35,                       /* ':'  */
+  YYSYMBOL_36_ = 36,                       /* ','  */
+  YYSYMBOL_YYACCEPT = 37,                  /* $accept  */
+  YYSYMBOL_map = 38,                       /* map  */
+  YYSYMBOL_line = 39,                      /* line  */
+  YYSYMBOL_number = 40,                    /* number  */
+  YYSYMBOL_decimal = 41,                   /* decimal  */
+  YYSYMBOL_parameter = 42,                 /* parameter  */
+  YYSYMBOL_section = 43,                   /* section  */
+  YYSYMBOL_mapping = 44,                   /* mapping  */
+  YYSYMBOL_inspec = 45,                    /* inspec  */
+  YYSYMBOL_joytype = 46,                   /* joytype  */
+  YYSYMBOL_outspec = 47,                   /* outspec  */
+  YYSYMBOL_miditype = 48,                  /* miditype  */
+  YYSYMBOL_widespec = 49,                  /* widespec  */
+  YYSYMBOL_widetype = 50,                  /* widetype  */
+  YYSYMBOL_options = 51,                   /* options  */
+  YYSYMBOL_curve = 52,                     /* curve  */
+  YYSYMBOL_points = 53                     /* points  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
 
-#line 195 "parser.tab.c" /* yacc.c:358  */
 
 #ifdef short
 # undef short
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
-typedef unsigned char yytype_uint8;
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
 #else
 typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -226,15 +336,28 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -248,47 +371,43 @@ typedef short int yytype_int16;
 # endif
 #endif
 
-#ifndef YY_ATTRIBUTE
-# if (defined __GNUC__                                               \
-      && (2 < __GNUC__ || (__GNUC__ == 2 && 96 <= __GNUC_MINOR__)))  \
-     || defined __SUNPRO_C && 0x5110 <= __SUNPRO_C
-#  define YY_ATTRIBUTE(Spec) __attribute__(Spec)
-# else
-#  define YY_ATTRIBUTE(Spec) /* empty */
-# endif
-#endif
 
 #ifndef YY_ATTRIBUTE_PURE
-# define YY_ATTRIBUTE_PURE   YY_ATTRIBUTE ((__pure__))
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
 #endif
 
 #ifndef YY_ATTRIBUTE_UNUSED
-# define YY_ATTRIBUTE_UNUSED YY_ATTRIBUTE ((__unused__))
-#endif
-
-#if !defined _Noreturn \
-     && (!defined __STDC_VERSION__ || __STDC_VERSION__ < 201112)
-# if defined _MSC_VER && 1200 <= _MSC_VER
-#  define _Noreturn __declspec (noreturn)
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
 # else
-#  define _Noreturn YY_ATTRIBUTE ((__noreturn__))
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN \
-    _Pragma ("GCC diagnostic push") \
-    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")\
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END \
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
 # define YY_INITIAL_VALUE(Value) Value
@@ -301,8 +420,22 @@ typedef short int yytype_int16;
 # define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if 1
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -367,8 +500,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* 1 */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -378,18 +510,19 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
   YYLTYPE yyls_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE) + sizeof (YYLTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
       + 2 * YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -402,11 +535,11 @@ union yyalloc
 # define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
     do                                                                  \
       {                                                                 \
-        YYSIZE_T yynewbytes;                                            \
+        YYPTRDIFF_T yynewbytes;                                         \
         YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
         Stack = &yyptr->Stack_alloc;                                    \
-        yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-        yyptr += yynewbytes / sizeof (*yyptr);                          \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
       }                                                                 \
     while (0)
 
@@ -418,12 +551,12 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
@@ -435,39 +568,42 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  2
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   45
+#define YYLAST   95
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  20
+#define YYNTOKENS  37
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  10
+#define YYNNTS  17
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  26
+#define YYNRULES  57
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  56
+#define YYNSTATES  112
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   282
 
-/* YYTRANSLATE[YYX] -- Symbol number corresponding to YYX as returned
-   by yylex, with out-of-bounds checking.  */
-#define YYUNDEFTOK  2
-#define YYMAXUTOK   267
 
-#define YYTRANSLATE(YYX)                                                \
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
-   as returned by yylex, without out-of-bounds checking.  */
-static const yytype_uint8 yytranslate[] =
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      13,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+      28,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,     2,    14,    19,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,    15,    16,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,    36,    29,    34,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,    35,     2,
+       2,    30,    31,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,    17,     2,    18,     2,     2,     2,     2,     2,     2,
+       2,    32,     2,    33,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -484,172 +620,221 @@ static const yytype_uint8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
-       5,     6,     7,     8,     9,    10,    11,    12
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
-static const yytype_uint8 yyrline[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,    51,    51,    52,    56,    57,    58,    62,    63,    67,
-      68,    69,    73,    77,    89,    95,   104,   105,   109,   110,
-     115,   120,   125,   131,   137,   146,   147
+       0,    83,    83,    84,    88,    89,    90,    91,    95,    96,
+     100,   101,   105,   106,   107,   111,   112,   113,   114,   118,
+     122,   126,   138,   144,   153,   154,   158,   159,   164,   169,
+     174,   179,   184,   189,   195,   201,   210,   211,   215,   228,
+     229,   233,   234,   238,   243,   248,   253,   257,   261,   265,
+     275,   276,   280,   284,   288,   292,   296,   302
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 1
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if 1
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "NUM", "\"axis\"", "\"button\"",
-  "\"note\"", "\"control\"", "\"bend\"", "\"ignore\"", "\"verbosity\"",
-  "\"debounce\"", "\"channel\"", "'\\n'", "'-'", "'='", "'>'", "'['",
-  "']'", "'.'", "$accept", "map", "line", "number", "parameter", "mapping",
-  "inspec", "joytype", "outspec", "miditype", YY_NULLPTR
+  "\"end of file\"", "error", "\"invalid token\"", "NUM", "DECIMAL",
+  "STRING", "\"axis\"", "\"button\"", "\"note\"", "\"control\"",
+  "\"control14\"", "\"nrpn\"", "\"bend\"", "\"ignore\"", "\"verbosity\"",
+  "\"debounce\"", "\"channel\"", "\"tables\"", "\"coalesce\"", "\"port\"",
+  "\"device\"", "\"curve\"", "\"linear\"", "\"exp\"", "\"scurve\"",
+  "\"smooth\"", "\"deadband\"", "\"interval\"", "'\\n'", "'-'", "'='",
+  "'>'", "'['", "']'", "'.'", "':'", "','", "$accept", "map", "line",
+  "number", "decimal", "parameter", "section", "mapping", "inspec",
+  "joytype", "outspec", "miditype", "widespec", "widetype", "options",
+  "curve", "points", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,    10,    45,    61,    62,    91,    93,    46
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF -16
+#define YYPACT_NINF (-28)
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-16)))
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF -1
+#define YYTABLE_NINF (-1)
 
-#define yytable_value_is_error(Yytable_value) \
+#define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int8 yypact[] =
 {
-     -16,     5,   -16,   -16,   -16,    -7,     4,     6,   -16,   -16,
-       7,    14,    15,     8,     8,     8,     8,   -16,   -16,    13,
-     -16,    28,    16,   -16,   -16,   -16,    17,   -16,     8,   -16,
-     -16,    18,   -16,   -16,    29,   -15,    31,    19,   -16,    20,
-     -12,    34,     8,   -16,    21,    -6,    23,    35,   -16,    24,
-     -16,    26,    39,   -16,    27,   -16
+     -28,    10,   -28,   -28,   -28,   -17,    21,    22,    23,    24,
+      27,    50,   -28,   -28,    29,    30,    31,    32,     2,     2,
+       2,     2,     2,     2,   -28,   -28,   -28,   -28,   -28,    34,
+     -28,    57,    35,   -28,     2,   -28,   -28,   -28,    36,   -28,
+       2,   -28,   -28,   -28,   -28,   -28,    37,   -28,   -28,    58,
+      38,    60,   -27,    61,    -7,    39,    63,   -28,   -28,    40,
+     -11,    65,    67,    11,    33,    70,    72,    73,     6,     2,
+     -28,    43,   -28,   -28,   -28,     2,    75,    76,   -28,   -28,
+     -28,    77,   -28,   -28,     8,   -28,    47,    49,    80,   -28,
+     -28,    51,   -25,   -28,   -28,    53,    81,   -28,    52,    85,
+     -28,    86,    87,    59,   -28,   -28,    56,    62,   -28,    90,
+     -28,   -28
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
-       2,     0,     1,    16,    17,     0,     0,     0,     4,     3,
-       0,     0,     0,     0,     0,     0,     0,     5,     6,     0,
-       7,     0,    13,     9,    10,    11,     0,     8,     0,    25,
-      26,    19,    18,    12,     0,     0,     0,    22,    14,     0,
-       0,     0,     0,    20,     0,     0,     0,     0,    23,     0,
-      15,     0,     0,    21,     0,    24
+       2,     0,     1,    24,    25,     0,     0,     0,     0,     0,
+       0,     0,     4,     3,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    18,    19,     5,     6,     7,     0,
+       8,     0,    21,    12,    13,    15,    16,    17,     0,     9,
+       0,    14,    36,    37,    39,    40,    27,    26,    41,     0,
+      30,     0,     0,     0,    20,    33,     0,    38,    22,     0,
+       0,     0,     0,     0,    43,     0,     0,     0,     0,     0,
+      28,     0,    49,    48,    50,    51,    53,     0,    42,    10,
+      11,    44,    46,    47,     0,    31,     0,     0,     0,    52,
+      54,     0,     0,    45,    34,     0,     0,    23,     0,     0,
+      55,     0,     0,     0,    29,    56,     0,     0,    32,     0,
+      35,    57
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
-     -16,   -16,   -16,   -14,   -16,   -16,   -16,   -16,   -16,   -16
+     -28,   -28,   -28,   -19,   -28,   -28,   -28,   -28,   -28,   -28,
+     -28,   -28,   -28,   -28,   -28,   -28,   -28
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
+/* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-      -1,     1,     9,    22,    10,    11,    12,    13,    33,    34
+       0,     1,    13,    32,    81,    14,    15,    16,    17,    18,
+      48,    49,    50,    51,    54,    78,    92
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
-static const yytype_uint8 yytable[] =
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
 {
-      23,    24,    25,    38,    39,     2,    43,    44,    14,     3,
-       4,    20,    48,    49,    35,     5,     6,     7,     8,    15,
-      17,    16,    21,    29,    30,    31,    32,    18,    46,    26,
-      19,    27,    37,    28,    40,    36,    41,    45,    51,    42,
-      47,    50,    54,    52,    53,    55
+      33,    34,    35,    36,    37,    30,    58,    59,   100,    61,
+       2,   101,    62,    19,    63,    41,     3,     4,    64,    65,
+      66,    52,    70,    71,     5,     6,     7,     8,     9,    10,
+      11,    31,    24,    74,    75,    76,    79,    80,    12,    85,
+      86,    94,    95,    77,    42,    43,    44,    45,    46,    47,
+      87,    20,    21,    22,    23,    25,    89,    26,    27,    28,
+      39,    55,    29,    57,    60,    38,    68,    40,    72,    53,
+      56,    67,    73,    82,    69,    83,    84,    88,    90,    91,
+      93,    96,    97,    98,   103,   104,    99,   102,   105,   106,
+     107,   109,   108,   111,     0,   110
 };
 
-static const yytype_uint8 yycheck[] =
+static const yytype_int8 yycheck[] =
 {
-      14,    15,    16,    18,    19,     0,    18,    19,    15,     4,
-       5,     3,    18,    19,    28,    10,    11,    12,    13,    15,
-      13,    15,    14,     6,     7,     8,     9,    13,    42,    16,
-      15,     3,     3,    17,     3,    17,    17,     3,     3,    19,
-      19,    18,     3,    19,    18,    18
+      19,    20,    21,    22,    23,     3,    33,    34,    33,    16,
+       0,    36,    19,    30,    21,    34,     6,     7,    25,    26,
+      27,    40,    33,    34,    14,    15,    16,    17,    18,    19,
+      20,    29,     5,    22,    23,    24,     3,     4,    28,    33,
+      34,    33,    34,    32,     8,     9,    10,    11,    12,    13,
+      69,    30,    30,    30,    30,     5,    75,    28,    28,    28,
+       3,     3,    30,     3,     3,    31,     3,    32,     3,    32,
+      32,    32,     5,     3,    34,     3,     3,    34,     3,     3,
+       3,    34,    33,     3,     3,    33,    35,    34,     3,     3,
+       3,    35,    33,     3,    -1,    33
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
-       0,    21,     0,     4,     5,    10,    11,    12,    13,    22,
-      24,    25,    26,    27,    15,    15,    15,    13,    13,    15,
-       3,    14,    23,    23,    23,    23,    16,     3,    17,     6,
-       7,     8,     9,    28,    29,    23,    17,     3,    18,    19,
-       3,    17,    19,    18,    19,     3,    23,    19,    18,    19,
-      18,     3,    19,    18,     3,    18
+       0,    38,     0,     6,     7,    14,    15,    16,    17,    18,
+      19,    20,    28,    39,    42,    43,    44,    45,    46,    30,
+      30,    30,    30,    30,     5,     5,    28,    28,    28,    30,
+       3,    29,    40,    40,    40,    40,    40,    40,    31,     3,
+      32,    40,     8,     9,    10,    11,    12,    13,    47,    48,
+      49,    50,    40,    32,    51,     3,    32,     3,    33,    34,
+       3,    16,    19,    21,    25,    26,    27,    32,     3,    34,
+      33,    34,     3,     5,    22,    23,    24,    32,    52,     3,
+       4,    41,     3,     3,     3,    33,    34,    40,    34,    40,
+       3,     3,    53,     3,    33,    34,    34,    33,     3,    35,
+      33,    36,    34,     3,    33,     3,     3,     3,    33,    35,
+      33,     3
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
-       0,    20,    21,    21,    22,    22,    22,    23,    23,    24,
-      24,    24,    25,    26,    26,    26,    27,    27,    28,    28,
-      28,    28,    28,    28,    28,    29,    29
+       0,    37,    38,    38,    39,    39,    39,    39,    40,    40,
+      41,    41,    42,    42,    42,    42,    42,    42,    42,    43,
+      44,    45,    45,    45,    46,    46,    47,    47,    47,    47,
+      47,    47,    47,    47,    47,    47,    48,    48,    49,    50,
+      50,    51,    51,    51,    51,    51,    51,    51,    51,    51,
+      52,    52,    52,    52,    52,    52,    53,    53
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
-       0,     2,     0,     2,     1,     2,     2,     1,     2,     3,
-       3,     3,     4,     2,     5,     8,     1,     1,     1,     1,
-       4,     7,     2,     5,     8,     1,     1
+       0,     2,     0,     2,     1,     2,     2,     2,     1,     2,
+       1,     1,     3,     3,     4,     3,     3,     3,     2,     2,
+       5,     2,     5,     8,     1,     1,     1,     1,     4,     7,
+       1,     4,     7,     2,     5,     8,     1,     1,     2,     1,
+       1,     0,     3,     2,     3,     4,     3,     3,     3,     3,
+       1,     1,     2,     1,     2,     3,     3,     5
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)                                  \
-do                                                              \
-  if (yychar == YYEMPTY)                                        \
-    {                                                           \
-      yychar = (Token);                                         \
-      yylval = (Value);                                         \
-      YYPOPSTACK (yylen);                                       \
-      yystate = *yyssp;                                         \
-      goto yybackup;                                            \
-    }                                                           \
-  else                                                          \
-    {                                                           \
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;                                                  \
-    }                                                           \
-while (0)
-
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 /* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
    If N is 0, then set CURRENT to the empty location which ends
@@ -693,20 +878,27 @@ do {                                            \
 } while (0)
 
 
-/* YY_LOCATION_PRINT -- Print the location on the stream.
+/* YYLOCATION_PRINT -- Print the location on the stream.
    This macro was not mandated originally: define only if we know
    we won't break user code: when these are the locations we know.  */
 
-#ifndef YY_LOCATION_PRINT
-# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
 
 /* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
 
 YY_ATTRIBUTE_UNUSED
-static unsigned
+static int
 yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
 {
-  unsigned res = 0;
+  int res = 0;
   int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
   if (0 <= yylocp->first_line)
     {
@@ -726,63 +918,249 @@ yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
         res += YYFPRINTF (yyo, "-%d", end_col);
     }
   return res;
- }
+}
 
-#  define YY_LOCATION_PRINT(File, Loc)          \
-  yy_location_print_ (File, &(Loc))
+#   define YYLOCATION_PRINT  yy_location_print_
 
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
 
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value, Location); \
+                  Kind, Value, Location); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
 
 
-/*----------------------------------------.
-| Print this symbol's value on YYOUTPUT.  |
-`----------------------------------------*/
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
 {
-  FILE *yyo = yyoutput;
-  YYUSE (yyo);
-  YYUSE (yylocationp);
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# endif
-  YYUSE (yytype);
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  switch (yykind)
+    {
+    case YYSYMBOL_NUM: /* NUM  */
+#line 76 "parser.c"
+         { fprintf(yyo, "%d", ((*yyvaluep).NUM)); }
+#line 972 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_DECIMAL: /* DECIMAL  */
+#line 77 "parser.c"
+         { fprintf(yyo, "%g", ((*yyvaluep).DECIMAL)); }
+#line 978 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_AXIS: /* "axis"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 984 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_BUTTON: /* "button"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 990 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_NOTE: /* "note"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 996 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_CONTROL: /* "control"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1002 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_CONTROL14: /* "control14"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1008 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_NRPN: /* "nrpn"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1014 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_BEND: /* "bend"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1020 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_IGNORE: /* "ignore"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1026 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_VERBOSITY: /* "verbosity"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1032 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_DEBOUNCE: /* "debounce"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1038 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_CHANNEL: /* "channel"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1044 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_TABLES: /* "tables"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1050 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_COALESCE: /* "coalesce"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1056 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_PORT: /* "port"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1062 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_DEVICE: /* "device"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1068 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_CURVE: /* "curve"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1074 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_LINEAR: /* "linear"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1080 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_EXPONENTIAL: /* "exp"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1086 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_SCURVE: /* "scurve"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1092 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_SMOOTH: /* "smooth"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1098 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_DEADBAND: /* "deadband"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1104 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_INTERVAL: /* "interval"  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1110 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_number: /* number  */
+#line 76 "parser.c"
+         { fprintf(yyo, "%d", ((*yyvaluep).NUM)); }
+#line 1116 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_decimal: /* decimal  */
+#line 77 "parser.c"
+         { fprintf(yyo, "%g", ((*yyvaluep).DECIMAL)); }
+#line 1122 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_joytype: /* joytype  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1128 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_miditype: /* miditype  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1134 "parser.tab.c"
+        break;
+
+    case YYSYMBOL_widetype: /* widetype  */
+#line 78 "parser.c"
+         { fprintf(yyo, "[%d]", ((*yyvaluep).type)); }
+#line 1140 "parser.tab.c"
+        break;
+
+      default:
+        break;
+    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
 {
-  YYFPRINTF (yyoutput, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  YY_LOCATION_PRINT (yyoutput, *yylocationp);
-  YYFPRINTF (yyoutput, ": ");
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep, yylocationp);
-  YYFPRINTF (yyoutput, ")");
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -791,7 +1169,7 @@ yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYL
 `------------------------------------------------------------------*/
 
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -814,21 +1192,22 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yytype_int16 *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp, int yyrule)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule)
 {
-  unsigned long int yylno = yyrline[yyrule];
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
              yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[yyssp[yyi + 1 - yynrhs]],
-                       &yyvsp[(yyi + 1) - (yynrhs)]
-                       , &(yylsp[(yyi + 1) - (yynrhs)])                       );
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]));
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -843,8 +1222,8 @@ do {                                    \
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -867,28 +1246,77 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
+/* Context of a parse error.  */
+typedef struct
+{
+  yy_state_t *yyssp;
+  yysymbol_kind_t yytoken;
+  YYLTYPE *yylloc;
+} yypcontext_t;
+
+/* Put in YYARG at most YYARGN of the expected tokens given the
+   current YYCTX, and return the number of tokens stored in YYARG.  If
+   YYARG is null, return the number of expected tokens (guaranteed to
+   be less than YYNTOKENS).  Return YYENOMEM on memory exhaustion.
+   Return 0 if there are more than YYARGN expected tokens, yet fill
+   YYARG up to YYARGN. */
+static int
+yypcontext_expected_tokens (const yypcontext_t *yyctx,
+                            yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  int yyn = yypact[+*yyctx->yyssp];
+  if (!yypact_value_is_default (yyn))
+    {
+      /* Start YYX at -YYN if negative to avoid negative indexes in
+         YYCHECK.  In other words, skip the first -YYN actions for
+         this state because they are default actions.  */
+      int yyxbegin = yyn < 0 ? -yyn : 0;
+      /* Stay within bounds of both yycheck and yytname.  */
+      int yychecklim = YYLAST - yyn + 1;
+      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
+      int yyx;
+      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
+        if (yycheck[yyx + yyn] == yyx && yyx != YYSYMBOL_YYerror
+            && !yytable_value_is_error (yytable[yyx + yyn]))
+          {
+            if (!yyarg)
+              ++yycount;
+            else if (yycount == yyargn)
+              return 0;
+            else
+              yyarg[yycount++] = YY_CAST (yysymbol_kind_t, yyx);
+          }
+    }
+  if (yyarg && yycount == 0 && 0 < yyargn)
+    yyarg[0] = YYSYMBOL_YYEMPTY;
+  return yycount;
+}
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
+
+
+
+#ifndef yystrlen
+# if defined __GLIBC__ && defined _STRING_H
+#  define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
+# else
 /* Return the length of YYSTR.  */
-static YYSIZE_T
+static YYPTRDIFF_T
 yystrlen (const char *yystr)
 {
-  YYSIZE_T yylen;
+  YYPTRDIFF_T yylen;
   for (yylen = 0; yystr[yylen]; yylen++)
     continue;
   return yylen;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
+#ifndef yystpcpy
+# if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
+#  define yystpcpy stpcpy
+# else
 /* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
    YYDEST.  */
 static char *
@@ -902,10 +1330,10 @@ yystpcpy (char *yydest, const char *yysrc)
 
   return yyd - 1;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yytnamerr
+#ifndef yytnamerr
 /* Copy to YYRES the contents of YYSTR after stripping away unnecessary
    quotes and backslashes, so that it's suitable for yyerror.  The
    heuristic is that double-quoting is unnecessary unless the string
@@ -913,14 +1341,13 @@ yystpcpy (char *yydest, const char *yysrc)
    backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
    null, do not copy; instead, return the length of what the result
    would have been.  */
-static YYSIZE_T
+static YYPTRDIFF_T
 yytnamerr (char *yyres, const char *yystr)
 {
   if (*yystr == '"')
     {
-      YYSIZE_T yyn = 0;
+      YYPTRDIFF_T yyn = 0;
       char const *yyp = yystr;
-
       for (;;)
         switch (*++yyp)
           {
@@ -931,7 +1358,10 @@ yytnamerr (char *yyres, const char *yystr)
           case '\\':
             if (*++yyp != '\\')
               goto do_not_strip_quotes;
-            /* Fall through.  */
+            else
+              goto append;
+
+          append:
           default:
             if (yyres)
               yyres[yyn] = *yyp;
@@ -946,36 +1376,20 @@ yytnamerr (char *yyres, const char *yystr)
     do_not_strip_quotes: ;
     }
 
-  if (! yyres)
+  if (yyres)
+    return yystpcpy (yyres, yystr) - yyres;
+  else
     return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
 }
-# endif
+#endif
 
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
 
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
 static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
+yy_syntax_error_arguments (const yypcontext_t *yyctx,
+                           yysymbol_kind_t yyarg[], int yyargn)
 {
-  YYSIZE_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
+  /* Actual size of YYARG. */
   int yycount = 0;
-
   /* There are many possibilities here to consider:
      - If this state is a consistent state with a default action, then
        the only way this function was invoked is if the default action
@@ -999,63 +1413,78 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
        one exception: it will still contain any token that will not be
        accepted due to an error action in a later state.
   */
-  if (yytoken != YYEMPTY)
+  if (yyctx->yytoken != YYSYMBOL_YYEMPTY)
     {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (! (yysize <= yysize1
-                         && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                    return 2;
-                  yysize = yysize1;
-                }
-              }
-        }
+      int yyn;
+      if (yyarg)
+        yyarg[yycount] = yyctx->yytoken;
+      ++yycount;
+      yyn = yypcontext_expected_tokens (yyctx,
+                                        yyarg ? yyarg + 1 : yyarg, yyargn - 1);
+      if (yyn == YYENOMEM)
+        return YYENOMEM;
+      else
+        yycount += yyn;
     }
+  return yycount;
+}
+
+/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
+   about the unexpected token YYTOKEN for the state stack whose top is
+   YYSSP.
+
+   Return 0 if *YYMSG was successfully written.  Return -1 if *YYMSG is
+   not large enough to hold the message.  In that case, also set
+   *YYMSG_ALLOC to the required number of bytes.  Return YYENOMEM if the
+   required number of bytes is too large to store.  */
+static int
+yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
+                const yypcontext_t *yyctx)
+{
+  enum { YYARGS_MAX = 5 };
+  /* Internationalized format string. */
+  const char *yyformat = YY_NULLPTR;
+  /* Arguments of yyformat: reported tokens (one for the "unexpected",
+     one per "expected"). */
+  yysymbol_kind_t yyarg[YYARGS_MAX];
+  /* Cumulated lengths of YYARG.  */
+  YYPTRDIFF_T yysize = 0;
+
+  /* Actual size of YYARG. */
+  int yycount = yy_syntax_error_arguments (yyctx, yyarg, YYARGS_MAX);
+  if (yycount == YYENOMEM)
+    return YYENOMEM;
 
   switch (yycount)
     {
-# define YYCASE_(N, S)                      \
+#define YYCASE_(N, S)                       \
       case N:                               \
         yyformat = S;                       \
-      break
+        break
+    default: /* Avoid compiler warnings. */
       YYCASE_(0, YY_("syntax error"));
       YYCASE_(1, YY_("syntax error, unexpected %s"));
       YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
       YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
       YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
       YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
+#undef YYCASE_
     }
 
+  /* Compute error message size.  Don't count the "%s"s, but reserve
+     room for the terminator.  */
+  yysize = yystrlen (yyformat) - 2 * yycount + 1;
   {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-      return 2;
-    yysize = yysize1;
+    int yyi;
+    for (yyi = 0; yyi < yycount; ++yyi)
+      {
+        YYPTRDIFF_T yysize1
+          = yysize + yytnamerr (YY_NULLPTR, yytname[yyarg[yyi]]);
+        if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
+          yysize = yysize1;
+        else
+          return YYENOMEM;
+      }
   }
 
   if (*yymsg_alloc < yysize)
@@ -1064,7 +1493,7 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
       if (! (yysize <= *yymsg_alloc
              && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
         *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
+      return -1;
     }
 
   /* Avoid sprintf, as that infringes on the user's name space.
@@ -1076,41 +1505,50 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
     while ((*yyp = *yyformat) != '\0')
       if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
         {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
+          yyp += yytnamerr (yyp, yytname[yyarg[yyi++]]);
           yyformat += 2;
         }
       else
         {
-          yyp++;
-          yyformat++;
+          ++yyp;
+          ++yyformat;
         }
   }
   return 0;
 }
-#endif /* YYERROR_VERBOSE */
+
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocationp)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp)
 {
-  YYUSE (yyvaluep);
-  YYUSE (yylocationp);
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  switch (yykind)
+    {
+    case YYSYMBOL_STRING: /* STRING  */
+#line 33 "parser.c"
+            { free(((*yyvaluep).string)); }
+#line 1542 "parser.tab.c"
+        break;
+
+      default:
+        break;
+    }
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-
-
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 /* The semantic value of the lookahead symbol.  */
@@ -1125,6 +1563,8 @@ YYLTYPE yylloc
 int yynerrs;
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
@@ -1132,53 +1572,48 @@ int yynerrs;
 int
 yyparse (void)
 {
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
-       'yyls': related to locations.
+    int yyerrstatus = 0;
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    /* The semantic value stack.  */
+    /* The semantic value stack: array, bottom, top.  */
     YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
-    /* The location stack.  */
+    /* The location stack: array, bottom, top.  */
     YYLTYPE yylsa[YYINITDEPTH];
-    YYLTYPE *yyls;
-    YYLTYPE *yylsp;
-
-    /* The locations where the error started and ended.  */
-    YYLTYPE yyerror_range[3];
-
-    YYSIZE_T yystacksize;
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
   YYLTYPE yyloc;
 
-#if YYERROR_VERBOSE
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
   /* Buffer for error messages, and its allocated size.  */
   char yymsgbuf[128];
   char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+  YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
 
@@ -1186,43 +1621,49 @@ yyparse (void)
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yylsp = yyls = yylsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   yylsp[0] = yylloc;
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
         /* Give user a chance to reallocate the stack.  Use copies of
            these so that the &'s don't force the real ones into
            memory.  */
+        yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
-        yytype_int16 *yyss1 = yyss;
         YYLTYPE *yyls1 = yyls;
 
         /* Each stack pointer address is followed by the size of the
@@ -1230,32 +1671,29 @@ yyparse (void)
            conditional around just the two extra args, but that might
            be undefined if yyoverflow is a macro.  */
         yyoverflow (YY_("memory exhausted"),
-                    &yyss1, yysize * sizeof (*yyssp),
-                    &yyvs1, yysize * sizeof (*yyvsp),
-                    &yyls1, yysize * sizeof (*yylsp),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
                     &yystacksize);
-
-        yyls = yyls1;
         yyss = yyss1;
         yyvs = yyvs1;
+        yyls = yyls1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
 
       {
-        yytype_int16 *yyss1 = yyss;
+        yy_state_t *yyss1 = yyss;
         union yyalloc *yyptr =
-          (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
         YYSTACK_RELOCATE (yyls_alloc, yyls);
@@ -1264,31 +1702,32 @@ yyparse (void)
           YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
       yylsp = yyls + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-                  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
         YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1299,18 +1738,30 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
+      YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex ();
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1338,15 +1789,14 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
   *++yylsp = yylloc;
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1361,7 +1811,7 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
@@ -1377,157 +1827,411 @@ yyreduce:
      GCC warning that YYVAL may be used uninitialized.  */
   yyval = yyvsp[1-yylen];
 
-  /* Default location.  */
+  /* Default location. */
   YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 7:
-#line 62 "parser.c" /* yacc.c:1646  */
-    { (*(int*)(&yyval)) = (*(int*)(&yyvsp[0])); }
-#line 1389 "parser.tab.c" /* yacc.c:1646  */
+  case 8: /* number: NUM  */
+#line 95 "parser.c"
+          { (yyval.NUM) = (yyvsp[0].NUM); }
+#line 1840 "parser.tab.c"
     break;
 
-  case 8:
-#line 63 "parser.c" /* yacc.c:1646  */
-    { (*(int*)(&yyval)) = - (*(int*)(&yyvsp[0])); }
-#line 1395 "parser.tab.c" /* yacc.c:1646  */
+  case 9: /* number: '-' NUM  */
+#line 96 "parser.c"
+          { (yyval.NUM) = - (yyvsp[0].NUM); }
+#line 1846 "parser.tab.c"
     break;
 
-  case 9:
-#line 67 "parser.c" /* yacc.c:1646  */
-    { verbosity = (*(int*)(&yyvsp[0])); }
-#line 1401 "parser.tab.c" /* yacc.c:1646  */
+  case 10: /* decimal: NUM  */
+#line 100 "parser.c"
+          { (yyval.DECIMAL) = (yyvsp[0].NUM); }
+#line 1852 "parser.tab.c"
     break;
 
-  case 10:
-#line 68 "parser.c" /* yacc.c:1646  */
-    { debounce = (*(int*)(&yyvsp[0])); }
-#line 1407 "parser.tab.c" /* yacc.c:1646  */
+  case 11: /* decimal: DECIMAL  */
+#line 101 "parser.c"
+          { (yyval.DECIMAL) = (yyvsp[0].DECIMAL); }
+#line 1858 "parser.tab.c"
     break;
 
-  case 11:
-#line 69 "parser.c" /* yacc.c:1646  */
-    { channel = (((*(int*)(&yyvsp[0])) + 1) & 0xF); }
-#line 1413 "parser.tab.c" /* yacc.c:1646  */
+  case 12: /* parameter: "verbosity" '=' number  */
+#line 105 "parser.c"
+                       { loading_config->verbosity = (yyvsp[0].NUM); }
+#line 1864 "parser.tab.c"
     break;
 
-  case 12:
-#line 73 "parser.c" /* yacc.c:1646  */
-    { add_mapping((*(MapSpec*)(&yyvsp[-3])), (*(MapSpec*)(&yyvsp[0]))); }
-#line 1419 "parser.tab.c" /* yacc.c:1646  */
+  case 13: /* parameter: "debounce" '=' number  */
+#line 106 "parser.c"
+                       { loading_config->debounce.press = (yyvsp[0].NUM); }
+#line 1870 "parser.tab.c"
     break;
 
-  case 13:
-#line 77 "parser.c" /* yacc.c:1646  */
-    { 
-    (*(MapSpec*)(&yyval)).type = (*(int*)(&yyvsp[-1]));
-    (*(MapSpec*)(&yyval)).number = (*(int*)(&yyvsp[0]));
-    if ((*(int*)(&yyvsp[-1])) == AXIS) {
-      (*(MapSpec*)(&yyval)).min = -32767;
-      (*(MapSpec*)(&yyval)).max = 32767;
+  case 14: /* parameter: "debounce" '=' number number  */
+#line 107 "parser.c"
+                             {
+    loading_config->debounce.press = (yyvsp[-1].NUM);
+    loading_config->debounce.release = (yyvsp[0].NUM);
+  }
+#line 1879 "parser.tab.c"
+    break;
+
+  case 15: /* parameter: "channel" '=' number  */
+#line 111 "parser.c"
+                     { loading_config->channel = (((yyvsp[0].NUM) - 1) & 0xF); }
+#line 1885 "parser.tab.c"
+    break;
+
+  case 16: /* parameter: "tables" '=' number  */
+#line 112 "parser.c"
+                    { loading_config->use_tables = (yyvsp[0].NUM); }
+#line 1891 "parser.tab.c"
+    break;
+
+  case 17: /* parameter: "coalesce" '=' number  */
+#line 113 "parser.c"
+                      { loading_config->coalesce_window = (yyvsp[0].NUM); }
+#line 1897 "parser.tab.c"
+    break;
+
+  case 18: /* parameter: "port" STRING  */
+#line 114 "parser.c"
+              { declare_port((yyvsp[0].string)); }
+#line 1903 "parser.tab.c"
+    break;
+
+  case 19: /* section: "device" STRING  */
+#line 118 "parser.c"
+                { begin_section((yyvsp[0].string)); }
+#line 1909 "parser.tab.c"
+    break;
+
+  case 20: /* mapping: inspec '=' '>' outspec options  */
+#line 122 "parser.c"
+                                 { add_mapping((yyvsp[-4].spec), (yyvsp[-1].spec), (yyvsp[0].options)); }
+#line 1915 "parser.tab.c"
+    break;
+
+  case 21: /* inspec: joytype number  */
+#line 126 "parser.c"
+                 { 
+    (yyval.spec).type = (yyvsp[-1].type);
+    (yyval.spec).number = (yyvsp[0].NUM);
+    if ((yyvsp[-1].type) == AXIS) {
+      (yyval.spec).min = -32767;
+      (yyval.spec).max = 32767;
     }
-    else if ((*(int*)(&yyvsp[-1])) == BUTTON) {
-      (*(MapSpec*)(&yyval)).min = 0;
-      (*(MapSpec*)(&yyval)).max = 1;
+    else if ((yyvsp[-1].type) == BUTTON) {
+      (yyval.spec).min = 0;
+      (yyval.spec).max = 1;
     }
   }
-#line 1436 "parser.tab.c" /* yacc.c:1646  */
+#line 1932 "parser.tab.c"
     break;
 
-  case 14:
-#line 89 "parser.c" /* yacc.c:1646  */
-    {
-    (*(MapSpec*)(&yyval)).type = (*(int*)(&yyvsp[-4]));
-    (*(MapSpec*)(&yyval)).number = (*(int*)(&yyvsp[-3]));
-    (*(MapSpec*)(&yyval)).min = (*(int*)(&yyvsp[-1]));
-    (*(MapSpec*)(&yyval)).max = (*(int*)(&yyvsp[-1])); 
+  case 22: /* inspec: joytype number '[' number ']'  */
+#line 138 "parser.c"
+                                {
+    (yyval.spec).type = (yyvsp[-4].type);
+    (yyval.spec).number = (yyvsp[-3].NUM);
+    (yyval.spec).min = (yyvsp[-1].NUM);
+    (yyval.spec).max = (yyvsp[-1].NUM); 
   }
-#line 1447 "parser.tab.c" /* yacc.c:1646  */
+#line 1943 "parser.tab.c"
     break;
 
-  case 15:
-#line 95 "parser.c" /* yacc.c:1646  */
-    {
-    (*(MapSpec*)(&yyval)).type = (*(int*)(&yyvsp[-7])); 
-    (*(MapSpec*)(&yyval)).number = (*(int*)(&yyvsp[-6])); 
-    (*(MapSpec*)(&yyval)).min = (*(int*)(&yyvsp[-4])); 
-    (*(MapSpec*)(&yyval)).max = (*(int*)(&yyvsp[-1]));
+  case 23: /* inspec: joytype number '[' number '.' '.' number ']'  */
+#line 144 "parser.c"
+                                               {
+    (yyval.spec).type = (yyvsp[-7].type); 
+    (yyval.spec).number = (yyvsp[-6].NUM); 
+    (yyval.spec).min = (yyvsp[-4].NUM); 
+    (yyval.spec).max = (yyvsp[-1].NUM);
   }
-#line 1458 "parser.tab.c" /* yacc.c:1646  */
+#line 1954 "parser.tab.c"
     break;
 
-  case 18:
-#line 109 "parser.c" /* yacc.c:1646  */
-    { (*(MapSpec*)(&yyval)).type = (*(int*)(&yyvsp[0])); }
-#line 1464 "parser.tab.c" /* yacc.c:1646  */
+  case 26: /* outspec: "ignore"  */
+#line 158 "parser.c"
+         { (yyval.spec).type = (yyvsp[0].type); }
+#line 1960 "parser.tab.c"
     break;
 
-  case 19:
-#line 110 "parser.c" /* yacc.c:1646  */
-    {
-    (*(MapSpec*)(&yyval)).type = (*(int*)(&yyvsp[0]));
-    (*(MapSpec*)(&yyval)).min = 0x0000;
-    (*(MapSpec*)(&yyval)).max = 0x3FFF;
+  case 27: /* outspec: "bend"  */
+#line 159 "parser.c"
+       {
+    (yyval.spec).type = (yyvsp[0].type);
+    (yyval.spec).min = 0x0000;
+    (yyval.spec).max = 0x3FFF;
   }
-#line 1474 "parser.tab.c" /* yacc.c:1646  */
+#line 1970 "parser.tab.c"
     break;
 
-  case 20:
-#line 115 "parser.c" /* yacc.c:1646  */
-    {
-    (*(MapSpec*)(&yyval)).type = (*(int*)(&yyvsp[-3]));
-    (*(MapSpec*)(&yyval)).min = (*(int*)(&yyvsp[-1]));
-    (*(MapSpec*)(&yyval)).max = (*(int*)(&yyvsp[-1]));
+  case 28: /* outspec: "bend" '[' NUM ']'  */
+#line 164 "parser.c"
+                   {
+    (yyval.spec).type = (yyvsp[-3].type);
+    (yyval.spec).min = (yyvsp[-1].NUM);
+    (yyval.spec).max = (yyvsp[-1].NUM);
   }
-#line 1484 "parser.tab.c" /* yacc.c:1646  */
+#line 1980 "parser.tab.c"
     break;
 
-  case 21:
-#line 120 "parser.c" /* yacc.c:1646  */
-    {
-    (*(MapSpec*)(&yyval)).type = (*(int*)(&yyvsp[-6]));
-    (*(MapSpec*)(&yyval)).min = (*(int*)(&yyvsp[-4]));
-    (*(MapSpec*)(&yyval)).max = (*(int*)(&yyvsp[-1]));
+  case 29: /* outspec: "bend" '[' NUM '.' '.' NUM ']'  */
+#line 169 "parser.c"
+                               {
+    (yyval.spec).type = (yyvsp[-6].type);
+    (yyval.spec).min = (yyvsp[-4].NUM);
+    (yyval.spec).max = (yyvsp[-1].NUM);
   }
-#line 1494 "parser.tab.c" /* yacc.c:1646  */
+#line 1990 "parser.tab.c"
     break;
 
-  case 22:
-#line 125 "parser.c" /* yacc.c:1646  */
-    {
-    (*(MapSpec*)(&yyval)).type = (*(int*)(&yyvsp[-1]));
-    (*(MapSpec*)(&yyval)).number = (*(int*)(&yyvsp[0]));
-    (*(MapSpec*)(&yyval)).min = 0;
-    (*(MapSpec*)(&yyval)).max = 127;
+  case 30: /* outspec: widespec  */
+#line 174 "parser.c"
+           {
+    (yyval.spec) = (yyvsp[0].spec);
+    (yyval.spec).min = 0;
+    (yyval.spec).max = 0x3FFF;
   }
-#line 1505 "parser.tab.c" /* yacc.c:1646  */
+#line 2000 "parser.tab.c"
     break;
 
-  case 23:
-#line 131 "parser.c" /* yacc.c:1646  */
-    {
-    (*(MapSpec*)(&yyval)).type = (*(int*)(&yyvsp[-4]));
-    (*(MapSpec*)(&yyval)).number = (*(int*)(&yyvsp[-3]));
-    (*(MapSpec*)(&yyval)).min = (*(int*)(&yyvsp[-1]));
-    (*(MapSpec*)(&yyval)).max = (*(int*)(&yyvsp[-1]));
+  case 31: /* outspec: widespec '[' NUM ']'  */
+#line 179 "parser.c"
+                       {
+    (yyval.spec) = (yyvsp[-3].spec);
+    (yyval.spec).min = (yyvsp[-1].NUM);
+    (yyval.spec).max = (yyvsp[-1].NUM);
   }
-#line 1516 "parser.tab.c" /* yacc.c:1646  */
+#line 2010 "parser.tab.c"
     break;
 
-  case 24:
-#line 137 "parser.c" /* yacc.c:1646  */
-    {
-    (*(MapSpec*)(&yyval)).type = (*(int*)(&yyvsp[-7]));
-    (*(MapSpec*)(&yyval)).number = (*(int*)(&yyvsp[-6]));
-    (*(MapSpec*)(&yyval)).min = (*(int*)(&yyvsp[-4]));
-    (*(MapSpec*)(&yyval)).max = (*(int*)(&yyvsp[-1]));
+  case 32: /* outspec: widespec '[' NUM '.' '.' NUM ']'  */
+#line 184 "parser.c"
+                                   {
+    (yyval.spec) = (yyvsp[-6].spec);
+    (yyval.spec).min = (yyvsp[-4].NUM);
+    (yyval.spec).max = (yyvsp[-1].NUM);
+  }
+#line 2020 "parser.tab.c"
+    break;
+
+  case 33: /* outspec: miditype NUM  */
+#line 189 "parser.c"
+               {
+    (yyval.spec).type = (yyvsp[-1].type);
+    (yyval.spec).number = (yyvsp[0].NUM);
+    (yyval.spec).min = 0;
+    (yyval.spec).max = 127;
+  }
+#line 2031 "parser.tab.c"
+    break;
+
+  case 34: /* outspec: miditype NUM '[' NUM ']'  */
+#line 195 "parser.c"
+                           {
+    (yyval.spec).type = (yyvsp[-4].type);
+    (yyval.spec).number = (yyvsp[-3].NUM);
+    (yyval.spec).min = (yyvsp[-1].NUM);
+    (yyval.spec).max = (yyvsp[-1].NUM);
+  }
+#line 2042 "parser.tab.c"
+    break;
+
+  case 35: /* outspec: miditype NUM '[' NUM '.' '.' NUM ']'  */
+#line 201 "parser.c"
+                                       {
+    (yyval.spec).type = (yyvsp[-7].type);
+    (yyval.spec).number = (yyvsp[-6].NUM);
+    (yyval.spec).min = (yyvsp[-4].NUM);
+    (yyval.spec).max = (yyvsp[-1].NUM);
+  }
+#line 2053 "parser.tab.c"
+    break;
+
+  case 38: /* widespec: widetype NUM  */
+#line 215 "parser.c"
+               {
+    (yyval.spec).type = (yyvsp[-1].type);
+    (yyval.spec).number = (yyvsp[0].NUM);
+    if (((yyvsp[-1].type) == CONTROL14) && ((yyvsp[0].NUM) > 31)) {
+      yyerror("14-bit controllers are numbered from 0 to 31");
+    }
+    else if ((yyvsp[0].NUM) > 0x3FFF) {
+      yyerror("NRPNs are numbered from 0 to 16383");
+    }
+  }
+#line 2068 "parser.tab.c"
+    break;
+
+  case 41: /* options: %empty  */
+#line 233 "parser.c"
+         { (yyval.options) = default_map_options(); }
+#line 2074 "parser.tab.c"
+    break;
+
+  case 42: /* options: options "curve" curve  */
+#line 234 "parser.c"
+                      {
+    (yyval.options) = (yyvsp[-2].options);
+    (yyval.options).curve = (yyvsp[0].curve);
   }
-#line 1527 "parser.tab.c" /* yacc.c:1646  */
+#line 2083 "parser.tab.c"
     break;
 
+  case 43: /* options: options "smooth"  */
+#line 238 "parser.c"
+                 {
+    (yyval.options) = (yyvsp[-1].options);
+    (yyval.options).filter.cutoff = FILTER_DEFAULT_CUTOFF;
+    (yyval.options).filter.beta = FILTER_DEFAULT_BETA;
+  }
+#line 2093 "parser.tab.c"
+    break;
+
+  case 44: /* options: options "smooth" decimal  */
+#line 243 "parser.c"
+                         {
+    (yyval.options) = (yyvsp[-2].options);
+    (yyval.options).filter.cutoff = (yyvsp[0].DECIMAL);
+    (yyval.options).filter.beta = FILTER_DEFAULT_BETA;
+  }
+#line 2103 "parser.tab.c"
+    break;
+
+  case 45: /* options: options "smooth" decimal NUM  */
+#line 248 "parser.c"
+                             {
+    (yyval.options) = (yyvsp[-3].options);
+    (yyval.options).filter.cutoff = (yyvsp[-1].DECIMAL);
+    (yyval.options).filter.beta = (yyvsp[0].NUM);
+  }
+#line 2113 "parser.tab.c"
+    break;
+
+  case 46: /* options: options "deadband" NUM  */
+#line 253 "parser.c"
+                       {
+    (yyval.options) = (yyvsp[-2].options);
+    (yyval.options).filter.deadband = (yyvsp[0].NUM);
+  }
+#line 2122 "parser.tab.c"
+    break;
+
+  case 47: /* options: options "interval" NUM  */
+#line 257 "parser.c"
+                       {
+    (yyval.options) = (yyvsp[-2].options);
+    (yyval.options).filter.interval = (yyvsp[0].NUM);
+  }
+#line 2131 "parser.tab.c"
+    break;
+
+  case 48: /* options: options "port" STRING  */
+#line 261 "parser.c"
+                      {
+    (yyval.options) = (yyvsp[-2].options);
+    (yyval.options).port = find_port((yyvsp[0].string));
+  }
+#line 2140 "parser.tab.c"
+    break;
+
+  case 49: /* options: options "channel" NUM  */
+#line 265 "parser.c"
+                      {
+    (yyval.options) = (yyvsp[-2].options);
+    if (((yyvsp[0].NUM) < 1) || ((yyvsp[0].NUM) > 16)) {
+      yyerror("channels are numbered from 1 to 16");
+    }
+    (yyval.options).channel = ((yyvsp[0].NUM) - 1) & 0xF;
+  }
+#line 2152 "parser.tab.c"
+    break;
+
+  case 50: /* curve: "linear"  */
+#line 275 "parser.c"
+         { (yyval.curve).type = CURVE_LINEAR; }
+#line 2158 "parser.tab.c"
+    break;
+
+  case 51: /* curve: "exp"  */
+#line 276 "parser.c"
+              {
+    (yyval.curve).type = CURVE_EXPONENTIAL;
+    (yyval.curve).steepness = CURVE_DEFAULT_EXPONENTIAL;
+  }
+#line 2167 "parser.tab.c"
+    break;
+
+  case 52: /* curve: "exp" number  */
+#line 280 "parser.c"
+                     {
+    (yyval.curve).type = CURVE_EXPONENTIAL;
+    (yyval.curve).steepness = (yyvsp[0].NUM);
+  }
+#line 2176 "parser.tab.c"
+    break;
+
+  case 53: /* curve: "scurve"  */
+#line 284 "parser.c"
+         {
+    (yyval.curve).type = CURVE_S;
+    (yyval.curve).steepness = CURVE_DEFAULT_S;
+  }
+#line 2185 "parser.tab.c"
+    break;
+
+  case 54: /* curve: "scurve" NUM  */
+#line 288 "parser.c"
+             {
+    (yyval.curve).type = CURVE_S;
+    (yyval.curve).steepness = (yyvsp[0].NUM);
+  }
+#line 2194 "parser.tab.c"
+    break;
+
+  case 55: /* curve: '[' points ']'  */
+#line 292 "parser.c"
+                 { (yyval.curve) = (yyvsp[-1].curve); }
+#line 2200 "parser.tab.c"
+    break;
+
+  case 56: /* points: NUM ':' NUM  */
+#line 296 "parser.c"
+              {
+    (yyval.curve).type = CURVE_POINTS;
+    (yyval.curve).count = 1;
+    (yyval.curve).x[0] = (yyvsp[-2].NUM);
+    (yyval.curve).y[0] = (yyvsp[0].NUM);
+  }
+#line 2211 "parser.tab.c"
+    break;
+
+  case 57: /* points: points ',' NUM ':' NUM  */
+#line 302 "parser.c"
+                         {
+    (yyval.curve) = (yyvsp[-4].curve);
+    if ((yyval.curve).count >= CURVE_MAX_POINTS) {
+      yyerror("too many points in curve");
+    }
+    else if ((yyvsp[-2].NUM) < (yyval.curve).x[(yyval.curve).count - 1]) {
+      yyerror("curve points must be in order of input");
+    }
+    else {
+      (yyval.curve).x[(yyval.curve).count] = (yyvsp[-2].NUM);
+      (yyval.curve).y[(yyval.curve).count] = (yyvsp[0].NUM);
+      (yyval.curve).count++;
+    }
+  }
+#line 2230 "parser.tab.c"
+    break;
+
+
+#line 2234 "parser.tab.c"
 
-#line 1531 "parser.tab.c" /* yacc.c:1646  */
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -1541,11 +2245,10 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
   *++yylsp = yyloc;
@@ -1553,14 +2256,13 @@ yyreduce:
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
@@ -1571,50 +2273,45 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
-      yyerror (YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
       {
+        yypcontext_t yyctx
+          = {yyssp, yytoken, &yylloc};
         char const *yymsgp = YY_("syntax error");
         int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
+        yysyntax_error_status = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
         if (yysyntax_error_status == 0)
           yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
+        else if (yysyntax_error_status == -1)
           {
             if (yymsg != yymsgbuf)
               YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
+            yymsg = YY_CAST (char *,
+                             YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
+            if (yymsg)
               {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
+                yysyntax_error_status
+                  = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+                yymsgp = yymsg;
               }
             else
               {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
+                yymsg = yymsgbuf;
+                yymsg_alloc = sizeof yymsgbuf;
+                yysyntax_error_status = YYENOMEM;
               }
           }
         yyerror (yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
+        if (yysyntax_error_status == YYENOMEM)
+          YYNOMEM;
       }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
   yyerror_range[1] = yylloc;
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -1643,14 +2340,12 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  yyerror_range[1] = yylsp[1-yylen];
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
@@ -1666,13 +2361,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -1686,7 +2382,7 @@ yyerrlab1:
 
       yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp, yylsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -1697,13 +2393,11 @@ yyerrlab1:
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
   yyerror_range[2] = yylloc;
-  /* Using YYLLOC is tempting, but would change the location of
-     the lookahead.  YYLOC is available though.  */
-  YYLLOC_DEFAULT (yyloc, yyerror_range, 2);
-  *++yylsp = yyloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -1714,26 +2408,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -1749,49 +2447,112 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[*yyssp], yyvsp, yylsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
   if (yymsg != yymsgbuf)
     YYSTACK_FREE (yymsg);
-#endif
   return yyresult;
 }
-#line 150 "parser.c" /* yacc.c:1906  */
 
+#line 318 "parser.c"
 
-// parse the map file
-void parse_map() {
+
+// where the lexer is in the map file text
+static size_t lex_position = 0;
+// where the line the lexer is on starts
+static size_t line_start = 0;
+// where the line the last token started on starts, for showing errors
+static size_t token_line_start = 0;
+
+// parse the map file, returning the number of errors
+int parse_map() {
   // initialize the location structure
   yylloc.first_line = yylloc.last_line = 1;
   yylloc.first_column = yylloc.last_column = 0;
+  lex_position = line_start = token_line_start = 0;
   // parse
-  yyparse();
+  parse_errors = 0;
+  if ((yyparse() != 0) && (parse_errors == 0)) parse_errors++;
+  return(parse_errors);
+}
+
+// get the next character from the map file without consuming it, which is 
+//  a null character at the end of the file
+static unsigned char peekchar(void) {
+  return((lex_position < map_length) ? map_text[lex_position] : 0);
 }
 
-// get the next character from the map file
-unsigned char nextchar() {
+// consume the next character from the map file
+static unsigned char nextchar(void) {
+  unsigned char c = peekchar();
   ++yylloc.last_column;
-  // check for the end of the file so we don't keep reading
-  int c = fgetc(map_file);
-  if (c < 0) c = 0;
+  if (lex_position < map_length) lex_position++;
   return(c);
 }
-// backtrack in the map file by the given number of characters
-void backtrack(int count) {
+
+// give back characters the lexer consumed
+static void unread(size_t count) {
+  lex_position -= count;
   yylloc.last_column -= count;
-  fseek(map_file, - count, SEEK_CUR);
+}
+
+// keywords recognized by the lexer and the tokens they produce, arranged 
+//  so that keyword_hash gives each one a different slot (if you add one, 
+//  check there are still no collisions and adjust the hash if there are)
+#define KEYWORD_SLOTS 64
+#define KEYWORD_MIN_LENGTH 3
+#define KEYWORD_MAX_LENGTH 9
+static const struct {
+  const char *name;
+  int token;
+} keywords[KEYWORD_SLOTS] = {
+  [3] = { "axis", AXIS },
+  [4] = { "coalesce", COALESCE },
+  [8] = { "curve", CURVE },
+  [10] = { "interval", INTERVAL },
+  [12] = { "scurve", SCURVE },
+  [14] = { "device", DEVICE },
+  [16] = { "ignore", IGNORE },
+  [24] = { "tables", TABLES },
+  [25] = { "smooth", SMOOTH },
+  [31] = { "linear", LINEAR },
+  [33] = { "bend", BEND },
+  [36] = { "verbosity", VERBOSITY },
+  [39] = { "button", BUTTON },
+  [41] = { "control14", CONTROL14 },
+  [42] = { "exp", EXPONENTIAL },
+  [44] = { "note", NOTE },
+  [46] = { "channel", CHANNEL },
+  [53] = { "control", CONTROL },
+  [56] = { "nrpn", NRPN },
+  [57] = { "deadband", DEADBAND },
+  [58] = { "debounce", DEBOUNCE },
+  [59] = { "port", PORT }
+};
+
+// get the slot a word would have in the keyword table
+static unsigned int keyword_hash(const char *word, size_t length) {
+  return(((unsigned char)word[1] + (unsigned char)word[length - 1] + 
+          (22 * length)) & (KEYWORD_SLOTS - 1));
+}
+
+// get the token for a keyword, or 0 if the word isn't one
+static int keyword_token(const char *word, size_t length) {
+  if ((length < KEYWORD_MIN_LENGTH) || (length > KEYWORD_MAX_LENGTH)) 
+    return(0);
+  unsigned int slot = keyword_hash(word, length);
+  const char *name = keywords[slot].name;
+  if ((name == NULL) || (strlen(name) != length) || 
+      (memcmp(name, word, length) != 0)) return(0);
+  return(keywords[slot].token);
 }
 
 int yylex(void) {
-  int i, kwlen;
-  char kwbuf[16];
-  char kwc;
   unsigned char c = nextchar();
   // ignore whitespace
   while ((c == ' ') || (c == '\t')) {
@@ -1806,45 +2567,68 @@ int yylex(void) {
   // record the start position of the token
   yylloc.first_line = yylloc.last_line;
   yylloc.first_column = yylloc.last_column;
+  token_line_start = line_start;
   // parse numbers
   if (isdigit(c)) {
-    yylval.NUM = 0;
-    while (isdigit(c)) {
-      yylval.NUM = (yylval.NUM * 10) + (c - '0');
-      c = nextchar();
+    int whole = c - '0';
+    while (isdigit(peekchar())) {
+      whole = (whole * 10) + (nextchar() - '0');
     }
-    backtrack(1);
+    // a decimal point followed by a digit starts a fractional part, which 
+    //  keeps ranges like [0..5] from looking like one
+    if ((peekchar() == '.') && (lex_position + 1 < map_length) && 
+        (isdigit(map_text[lex_position + 1]))) {
+      double scale = 1.0;
+      yylval.DECIMAL = whole;
+      nextchar();
+      while (isdigit(peekchar())) {
+        scale /= 10.0;
+        yylval.DECIMAL += scale * (nextchar() - '0');
+      }
+      return(DECIMAL);
+    }
+    yylval.NUM = whole;
     return(NUM);
   }
+  // parse quoted strings
+  if (c == '"') {
+    const char *start = map_text + lex_position;
+    while ((peekchar() != '"') && (peekchar() != '\n') && (peekchar() != 0)) {
+      nextchar();
+    }
+    yylval.string = strndup(start, (map_text + lex_position) - start);
+    // consume the closing quote, leaving an unterminated string's line 
+    //  ending to end the line
+    if (peekchar() == '"') nextchar();
+    return(STRING);
+  }
   // parse keywords
   if (isalpha(c)) {
-    kwbuf[0] = c;
-    i = 0;
-    for (i = 1; i < 15; i++) {
-      kwc = nextchar();
-      kwbuf[i] = kwc;
-      if (! isalpha(kwc)) {
-        backtrack(1);
-        break;
-      }
+    const char *word = map_text + lex_position - 1;
+    size_t length = 1, letters = 1;
+    while (isalnum(peekchar())) {
+      if ((letters == length) && (isalpha(peekchar()))) letters++;
+      nextchar();
+      length++;
     }
-    kwbuf[i] = '\0';
-    kwlen = i;
-    for (i = 0; i < YYNTOKENS; i++) {
-      if ((yytname[i] != 0) && (yytname[i][0] == '"') && 
-          (! strncmp(yytname[i] + 1, kwbuf, kwlen)) &&
-          (yytname[i][kwlen + 1] == '"') &&
-          (yytname[i][kwlen + 2] == '\0')) {
-        yylval.type = yytoknum[i];
-        return(yytoknum[i]);
-      }
+    // keywords can end in digits, but a number can also follow a keyword 
+    //  directly, as in "axis0", so try just the letters too
+    int token = keyword_token(word, length);
+    if ((token == 0) && (letters < length)) {
+      token = keyword_token(word, letters);
+      if (token != 0) unread(length - letters);
+    }
+    if (token != 0) {
+      yylval.type = token;
+      return(token);
     }
-    backtrack(kwlen);
+    unread(length - 1);
   }
   // advance the line counter
   if (c == '\n') {
     ++yylloc.last_line;
     yylloc.last_column = 0;
+    line_start = lex_position;
   }
   // all other characters are single-character tokens
   return(c);
@@ -1852,38 +2636,19 @@ int yylex(void) {
 
 void yyerror(char const *s) {
   int i;
+  parse_errors++;
   // write the error message
   fprintf(stderr, "ERROR: in %s line %d: %s\n", map_path, yylloc.first_line, s);
   // write the relevant line of the file to the console for reference,
   //  just like GCC does it
-  char linebuf[1024];
-  fseek(map_file, 0, SEEK_SET);
-  int c = 0;
-  int line = 1;
-  while ((c >= 0) && (line < yylloc.first_line)) {
-    c = fgetc(map_file);
-    if (c == '\n') line++;
-  }
-  if (line == yylloc.first_line) {
-    for (i = 0; i < sizeof(linebuf); i++) {
-      c = fgetc(map_file);
-      if (c == '\n') {
-        linebuf[i] = '\0';
-        break;
-      }
-      linebuf[i] = c;
-    }
-    if ((i < sizeof(linebuf)) && (i >= yylloc.first_column)) {
-      fprintf(stderr, "%s\n", linebuf);
-      for (i = 0; i < (yylloc.first_column - 1); i++) {
-        fprintf(stderr, " ");
-      }
-      fprintf(stderr, "^\n");
+  const char *line = map_text + token_line_start;
+  const char *end = memchr(line, '\n', map_length - token_line_start);
+  int length = (end != NULL) ? end - line : map_length - token_line_start;
+  if (length >= yylloc.first_column) {
+    fprintf(stderr, "%.*s\n", length, line);
+    for (i = 0; i < (yylloc.first_column - 1); i++) {
+      fprintf(stderr, " ");
     }
+    fprintf(stderr, "^\n");
   }
 }
-
-static void print_token_value (FILE *file, int type, YYSTYPE value) {
-  if (type == NUM) fprintf(file, "%d", value.NUM);
-  else fprintf(file, "[%d]", type);
-}
@@ -0,0 +1,71 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "realtime.h"
+
+int realtime_lock_memory(void) {
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) return(1);
+  if ((errno == EPERM) || (errno == ENOMEM)) {
+    fprintf(stderr, "WARNING: Not allowed to lock memory, so pages may fault "
+      "in while running (raise the memlock limit in "
+      "/etc/security/limits.conf or run with CAP_IPC_LOCK).\n");
+  }
+  else {
+    fprintf(stderr, "WARNING: Failed to lock memory (%s).\n", strerror(errno));
+  }
+  return(0);
+}
+
+void realtime_prefault_stack(void) {
+  volatile unsigned char stack[REALTIME_STACK_SIZE];
+  size_t i;
+  long page = sysconf(_SC_PAGESIZE);
+  if (page <= 0) page = 4096;
+  for (i = 0; i < sizeof(stack); i += page) stack[i] = 0;
+}
+
+int realtime_schedule(int priority) {
+  int min = sched_get_priority_min(SCHED_FIFO);
+  int max = sched_get_priority_max(SCHED_FIFO);
+  if ((priority < min) || (priority > max)) {
+    fprintf(stderr, "WARNING: Real-time priority %d is out of range "
+      "(%d to %d).\n", priority, min, max);
+    return(0);
+  }
+  struct sched_param param;
+  memset(&param, 0, sizeof(param));
+  param.sched_priority = priority;
+  int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+  if (result == 0) return(1);
+  if (result == EPERM) {
+    fprintf(stderr, "WARNING: Not allowed to use real-time priority %d, "
+      "so input may be late under load (raise the rtprio limit in "
+      "/etc/security/limits.conf or run with CAP_SYS_NICE).\n", priority);
+  }
+  else {
+    fprintf(stderr, "WARNING: Failed to set real-time priority %d (%s).\n", 
+      priority, strerror(result));
+  }
+  return(0);
+}
+
+int realtime_pin(int cpu) {
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  if ((cpu < 0) || (cpu >= CPU_SETSIZE)) {
+    fprintf(stderr, "WARNING: There's no CPU %d to run on.\n", cpu);
+    return(0);
+  }
+  CPU_SET(cpu, &cpus);
+  int result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+  if (result == 0) return(1);
+  fprintf(stderr, "WARNING: Failed to run on CPU %d (%s).\n", 
+    cpu, strerror(result));
+  return(0);
+}
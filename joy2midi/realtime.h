@@ -0,0 +1,23 @@
+#ifndef JOY2MIDI_REALTIME_H
+#define JOY2MIDI_REALTIME_H
+
+#include <stddef.h>
+
+// the bytes of stack to touch before running in real time, which should 
+//  cover the deepest path through translating an event
+#define REALTIME_STACK_SIZE (256 * 1024)
+
+// lock all current and future memory into RAM so nothing that's already 
+//  mapped can page out or fault in later, returning 0 and warning if it 
+//  isn't allowed
+int realtime_lock_memory(void);
+// touch the calling thread's stack so it's mapped before it's needed
+void realtime_prefault_stack(void);
+// run the calling thread with SCHED_FIFO at the given priority, returning 
+//  0 and warning if it isn't allowed
+int realtime_schedule(int priority);
+// keep the calling thread on the given CPU, returning 0 and warning if it 
+//  can't be
+int realtime_pin(int cpu);
+
+#endif
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "evdev.h"
+#include "replay.h"
+
+// where replayed batches go
+typedef struct {
+  InputDevice *device;
+  InputHandlers *handlers;
+  void (*clock)(uint64_t time);
+} Replay;
+
+// send a batch of events that happened at the same time to the handlers
+static void dispatch_batch(void *context, JoystickEvent *batch, int count) {
+  Replay *replay = (Replay *)context;
+  replay->clock(batch[0].time);
+  int kept = input_collapse(batch, count);
+  replay->handlers->events(replay->device, batch, kept);
+}
+
+// replay events from the joystick API, returning how many there were
+static long replay_joystick(FILE *file, Replay *replay) {
+  struct js_event raw[INPUT_BATCH_SIZE];
+  JoystickEvent events[INPUT_BATCH_SIZE];
+  JoystickEvent batch[INPUT_BATCH_SIZE];
+  int i, count, batch_count = 0;
+  long total = 0;
+  // events that happened in the same millisecond make up a batch, as they 
+  //  would most likely be read together from a live device
+  while ((count = fread(raw, sizeof(struct js_event), 
+                        INPUT_BATCH_SIZE, file)) > 0) {
+    input_convert(raw, events, count);
+    for (i = 0; i < count; i++) {
+      if ((batch_count > 0) && 
+          ((events[i].time != batch[0].time) || 
+           (batch_count >= INPUT_BATCH_SIZE))) {
+        dispatch_batch(replay, batch, batch_count);
+        batch_count = 0;
+      }
+      batch[batch_count++] = events[i];
+    }
+    total += count;
+  }
+  if (batch_count > 0) dispatch_batch(replay, batch, batch_count);
+  return(total);
+}
+
+// replay events from evdev, returning how many there were
+static long replay_evdev(FILE *file, Replay *replay) {
+  static EvdevState state;
+  struct input_event raw[EVDEV_BATCH_SIZE];
+  int count;
+  long total = 0;
+  // each frame makes up a batch
+  evdev_init(&state, -1);
+  while ((count = fread(raw, sizeof(struct input_event), 
+                        EVDEV_BATCH_SIZE, file)) > 0) {
+    evdev_decode(&state, raw, count, dispatch_batch, replay);
+    total += count;
+  }
+  return(total);
+}
+
+long replay_file(const char *path, int evdev, InputHandlers *handlers, 
+                 void (*clock)(uint64_t time)) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    fprintf(stderr, "ERROR: Failed to open '%s' for replay.\n", path);
+    return(-1);
+  }
+  // stand in for a device that's been plugged in
+  InputDevice device;
+  memset(&device, 0, sizeof(device));
+  device.fd = -1;
+  device.clock = evdev ? INPUT_CLOCK_EVDEV : INPUT_CLOCK_JOYSTICK;
+  strncpy(device.path, path, sizeof(device.path) - 1);
+  strncpy(device.name, "Replay", sizeof(device.name) - 1);
+  if (handlers->opened != NULL) handlers->opened(&device);
+  Replay replay = { &device, handlers, clock };
+  long total = evdev ? 
+    replay_evdev(file, &replay) : replay_joystick(file, &replay);
+  if (handlers->closed != NULL) handlers->closed(&device);
+  fclose(file);
+  return(total);
+}
@@ -0,0 +1,16 @@
+#ifndef JOY2MIDI_REPLAY_H
+#define JOY2MIDI_REPLAY_H
+
+#include <stdint.h>
+
+#include "input.h"
+
+// read events recorded from a device (e.g. with `cat /dev/input/js0 > 
+//  recording`), or from an evdev device if evdev is set, and dispatch them 
+//  to the handlers as a single device, calling the clock function with the 
+//  time of each batch in microseconds before dispatching it; returns the 
+//  number of events read, or -1 if the file can't be read
+long replay_file(const char *path, int evdev, InputHandlers *handlers, 
+                 void (*clock)(uint64_t time));
+
+#endif
@@ -0,0 +1,75 @@
+#include <string.h>
+
+#include "ring.h"
+
+#define RING_MASK (RING_SIZE - 1)
+
+int midi_message_size(uint8_t status) {
+  // program change and channel pressure have a single data byte
+  if (((status & 0xF0) == 0xC0) || ((status & 0xF0) == 0xD0)) return(2);
+  return(3);
+}
+
+void ring_init(MidiRing *ring) {
+  memset(ring, 0, sizeof(MidiRing));
+}
+
+int ring_push(MidiRing *ring, const MidiEvent *event) {
+  return(ring_push_batch(ring, event, 1));
+}
+
+int ring_push_batch(MidiRing *ring, const MidiEvent *events, uint32_t count) {
+  uint32_t i;
+  // only the producer writes the head, so it can be read without ordering
+  uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+  uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  uint32_t waiting = head - tail;
+  if (waiting + count > RING_SIZE) {
+    __atomic_add_fetch(&ring->dropped, count, __ATOMIC_RELAXED);
+    return(0);
+  }
+  for (i = 0; i < count; i++) ring->events[(head + i) & RING_MASK] = events[i];
+  // publish all the events to the consumer together
+  __atomic_store_n(&ring->head, head + count, __ATOMIC_RELEASE);
+  if (waiting + count > ring->high_water) 
+    __atomic_store_n(&ring->high_water, waiting + count, __ATOMIC_RELAXED);
+  return(1);
+}
+
+MidiEvent *ring_peek(MidiRing *ring) {
+  uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+  uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  if (head == tail) return(NULL);
+  return(&ring->events[tail & RING_MASK]);
+}
+
+MidiEvent *ring_peek_at(MidiRing *ring, uint32_t index) {
+  uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+  uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  if (head - tail <= index) return(NULL);
+  return(&ring->events[(tail + index) & RING_MASK]);
+}
+
+void ring_pop(MidiRing *ring) {
+  uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+  // release the slot back to the producer
+  __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t ring_count(MidiRing *ring) {
+  uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  return(head - tail);
+}
+
+uint32_t ring_dropped(MidiRing *ring) {
+  return(__atomic_load_n(&ring->dropped, __ATOMIC_RELAXED));
+}
+
+void ring_drop(MidiRing *ring, uint32_t count) {
+  __atomic_add_fetch(&ring->dropped, count, __ATOMIC_RELAXED);
+}
+
+uint32_t ring_high_water(MidiRing *ring) {
+  return(__atomic_load_n(&ring->high_water, __ATOMIC_RELAXED));
+}
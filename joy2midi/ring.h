@@ -0,0 +1,80 @@
+#ifndef JOY2MIDI_RING_H
+#define JOY2MIDI_RING_H
+
+#include <stdint.h>
+
+// the number of events a ring can hold (must be a power of two)
+#define RING_SIZE 1024
+
+// the most bytes in an event, which is enough for a group of up to four 
+//  three-byte messages that have to be sent together and in order
+#define MIDI_EVENT_MAX 12
+// kinds of event, which tell coalescing how the messages relate
+// a single message
+#define MIDI_GROUP_NONE 0
+// a 14-bit controller's MSB and LSB, or just the LSB if the MSB is unchanged
+#define MIDI_GROUP_CONTROL14 1
+// an NRPN parameter selection and data entry, or the parts that changed
+#define MIDI_GROUP_NRPN 2
+
+// a fixed-size MIDI event as it passes between threads
+typedef struct {
+  // the frame time the event is scheduled relative to
+  uint32_t time;
+  // the number of valid bytes in data
+  uint8_t size;
+  // the kind of event (MIDI_GROUP_...)
+  uint8_t group;
+  // the output port to send the event on
+  uint8_t port;
+  // nonzero once the event has been left for a later period, so it isn't 
+  //  counted again when it comes up again (output thread only)
+  uint8_t spilled;
+  // event data, as one or more complete messages
+  uint8_t data[MIDI_EVENT_MAX];
+} MidiEvent;
+
+// get the number of bytes in a channel message with the given status byte
+int midi_message_size(uint8_t status);
+
+// a wait-free ring buffer with exactly one producer and one consumer thread
+typedef struct {
+  // the index of the next slot to write (only written by the producer)
+  uint32_t head;
+  // the index of the next slot to read (only written by the consumer)
+  uint32_t tail;
+  // the number of events that didn't fit in the ring
+  uint32_t dropped;
+  // the largest number of events that were ever waiting in the ring
+  uint32_t high_water;
+  MidiEvent events[RING_SIZE];
+} MidiRing;
+
+// reset the ring to an empty state (not thread-safe)
+void ring_init(MidiRing *ring);
+// add an event to the ring from the producer thread, returning 0 and 
+//  counting the event as dropped if the ring is full
+int ring_push(MidiRing *ring, const MidiEvent *event);
+// add several events to the ring from the producer thread so the consumer 
+//  sees all of them at once, returning 0 and counting them all as dropped 
+//  if they don't all fit
+int ring_push_batch(MidiRing *ring, const MidiEvent *events, uint32_t count);
+// get a pointer to the oldest event from the consumer thread without 
+//  removing it, or NULL if the ring is empty
+MidiEvent *ring_peek(MidiRing *ring);
+// get a pointer to the event at the given position from the oldest, or NULL 
+//  if there aren't that many events (consumer thread only)
+MidiEvent *ring_peek_at(MidiRing *ring, uint32_t index);
+// remove the oldest event from the consumer thread
+void ring_pop(MidiRing *ring);
+// get the number of events waiting in the ring
+uint32_t ring_count(MidiRing *ring);
+// get the number of events dropped because the ring was full
+uint32_t ring_dropped(MidiRing *ring);
+// count events meant for the ring as dropped without trying to add them 
+//  (producer thread only)
+void ring_drop(MidiRing *ring, uint32_t count);
+// get the largest number of events that were ever waiting in the ring
+uint32_t ring_high_water(MidiRing *ring);
+
+#endif
@@ -0,0 +1,136 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "serial_output.h"
+#include "serialize.h"
+
+// the rate of the frame clock, which only sets the timing resolution 
+//  since a byte stream has no timestamps
+#define SERIAL_RATE 48000
+// the number of frames in each period, which is one millisecond
+#define SERIAL_PERIOD (SERIAL_RATE / 1000)
+// the number of periods to go without sending before sending the next 
+//  status byte again, so a receiver plugged in later can join the stream
+#define SERIAL_REFRESH_PERIODS 1000
+
+// the device to write to
+static const char *device_path = NULL;
+static int device_fd = -1;
+// the thread that sends each period
+static pthread_t sender;
+static int running = 0;
+static MidiSerializer serializer;
+// the bytes to write in the current period
+static uint8_t buffer[RING_SIZE * MIDI_EVENT_MAX];
+static size_t buffered = 0;
+
+void serial_configure(const char *path) {
+  device_path = path;
+}
+
+static uint32_t serial_time(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return((uint32_t)(((uint64_t)now.tv_sec * SERIAL_RATE) + 
+    (((uint64_t)now.tv_nsec * SERIAL_RATE) / 1000000000)));
+}
+
+static uint32_t serial_rate(void) {
+  return(SERIAL_RATE);
+}
+
+// add a message to the bytes for the current period
+static int serial_write(void *context, int32_t time, 
+                        const uint8_t *data, size_t size) {
+  if (buffered + size > sizeof(buffer)) return(0);
+  buffered += serializer_write(&serializer, data, size, buffer + buffered);
+  return(1);
+}
+
+// send the messages for each period as it ends
+static void *send_thread(void *arg) {
+  struct timespec wake;
+  int port, idle = 0;
+  MidiSink sink = { serial_write, NULL };
+  uint32_t period_start = serial_time();
+  clock_gettime(CLOCK_MONOTONIC, &wake);
+  while (__atomic_load_n(&running, __ATOMIC_RELAXED)) {
+    // wait for the period to end
+    wake.tv_nsec += 1000000;
+    if (wake.tv_nsec >= 1000000000) {
+      wake.tv_nsec -= 1000000000;
+      wake.tv_sec++;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL);
+    uint32_t saved = serializer.saved;
+    buffered = 0;
+    // a byte stream has no ports, so they all share it
+    output_begin_period();
+    for (port = 0; port < output_port_count(); port++) {
+      output_process(port, &sink, period_start, SERIAL_PERIOD);
+    }
+    output_end_period();
+    period_start += SERIAL_PERIOD;
+    if (buffered == 0) {
+      if (++idle == SERIAL_REFRESH_PERIODS) serializer_refresh(&serializer);
+      continue;
+    }
+    idle = 0;
+    output_count_bytes(buffered, serializer.saved - saved);
+    size_t offset = 0;
+    while (offset < buffered) {
+      ssize_t length = write(device_fd, buffer + offset, buffered - offset);
+      if (length < 0) {
+        if (errno == EINTR) continue;
+        fprintf(stderr, "ERROR: Failed to write to '%s'.\n", device_path);
+        break;
+      }
+      offset += length;
+    }
+  }
+  return(NULL);
+}
+
+static int serial_start(const char *const *port_names, int port_count, 
+                        int coalesce_window) {
+  device_fd = open(device_path, O_WRONLY | O_NOCTTY);
+  if (device_fd < 0) { fprintf(stderr, 
+    "ERROR: Failed to open '%s' for MIDI output.\n", device_path);
+    return(0);
+  }
+  // pass bytes through a serial port untouched
+  struct termios options;
+  if (tcgetattr(device_fd, &options) == 0) {
+    cfmakeraw(&options);
+    tcsetattr(device_fd, TCSANOW, &options);
+  }
+  serializer_init(&serializer);
+  output_init(port_count, coalesce_window, SERIAL_RATE);
+  running = 1;
+  if (pthread_create(&sender, NULL, send_thread, NULL) != 0) {
+    fprintf(stderr, "ERROR: Failed to start sending MIDI.\n");
+    running = 0;
+    return(0);
+  }
+  return(1);
+}
+
+static int serial_priority(void) {
+  return(0);
+}
+
+static void serial_stop(void) {
+  if (__atomic_exchange_n(&running, 0, __ATOMIC_SEQ_CST)) {
+    pthread_join(sender, NULL);
+  }
+  if (device_fd >= 0) close(device_fd);
+  device_fd = -1;
+}
+
+OutputBackend serial_output = { 
+  serial_start, serial_time, serial_rate, serial_priority, serial_stop };
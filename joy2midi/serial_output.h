@@ -0,0 +1,12 @@
+#ifndef JOY2MIDI_SERIAL_OUTPUT_H
+#define JOY2MIDI_SERIAL_OUTPUT_H
+
+#include "output.h"
+
+// send MIDI as a byte stream to a serial port or raw MIDI device
+extern OutputBackend serial_output;
+
+// set the path of the device to write to (call before starting)
+void serial_configure(const char *path);
+
+#endif
@@ -0,0 +1,42 @@
+#include "serialize.h"
+
+void serializer_init(MidiSerializer *serializer) {
+  serializer->running_status = 0;
+  serializer->written = 0;
+  serializer->saved = 0;
+}
+
+size_t serializer_write(MidiSerializer *serializer, const uint8_t *data, 
+                        size_t size, uint8_t *buffer) {
+  size_t i, length = 0;
+  if (size == 0) return(0);
+  uint8_t status = data[0];
+  // system messages can't use running status and real-time ones don't 
+  //  affect it, but other system messages cancel it
+  if (status >= 0xF0) {
+    if (status < 0xF8) serializer->running_status = 0;
+    for (i = 0; i < size; i++) buffer[length++] = data[i];
+    serializer->written += length;
+    return(length);
+  }
+  // a note off with no velocity can be sent as a note on so that it 
+  //  shares running status with the note ons around it
+  if (((status & 0xF0) == 0x80) && (size == 3) && (data[2] == 0) && 
+      (serializer->running_status == (0x90 | (status & 0x0F)))) {
+    status = serializer->running_status;
+  }
+  if (status == serializer->running_status) {
+    serializer->saved++;
+  }
+  else {
+    buffer[length++] = status;
+    serializer->running_status = status;
+  }
+  for (i = 1; i < size; i++) buffer[length++] = data[i];
+  serializer->written += length;
+  return(length);
+}
+
+void serializer_refresh(MidiSerializer *serializer) {
+  serializer->running_status = 0;
+}
@@ -0,0 +1,29 @@
+#ifndef JOY2MIDI_SERIALIZE_H
+#define JOY2MIDI_SERIALIZE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// state for writing messages to a raw MIDI byte stream, such as a serial 
+//  port or a USB MIDI bridge, which leaves out status bytes that are the 
+//  same as the last one (running status)
+typedef struct {
+  // the status byte the receiver will assume, or 0 if it can't assume one
+  uint8_t running_status;
+  // the number of bytes written
+  uint32_t written;
+  // the number of bytes left out by using running status
+  uint32_t saved;
+} MidiSerializer;
+
+// reset the serializer and its counters
+void serializer_init(MidiSerializer *serializer);
+// write a complete message into a buffer with room for all of it, 
+//  returning the number of bytes written
+size_t serializer_write(MidiSerializer *serializer, const uint8_t *data, 
+                        size_t size, uint8_t *buffer);
+// send the status byte with the next message, so that a receiver that 
+//  was connected after the last one can pick up the stream
+void serializer_refresh(MidiSerializer *serializer);
+
+#endif
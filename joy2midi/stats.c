@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "debounce.h"
+#include "filter.h"
+#include "input.h"
+#include "output.h"
+#include "stats.h"
+
+// write all the statistics as a JSON object
+static void write_json(FILE *file) {
+  OutputStats stats;
+  OutputHistograms histograms;
+  FilterStats filtered;
+  output_get_stats(&stats);
+  output_get_histograms(&histograms);
+  filter_get_stats(&filtered);
+  fprintf(file, "{\n");
+  fprintf(file, "  \"time\": %lld,\n", (long long)time(NULL));
+  fprintf(file, "  \"sent\": %u,\n", stats.sent);
+  fprintf(file, "  \"late\": %u,\n", stats.late);
+  fprintf(file, "  \"spilled\": %u,\n", stats.spilled);
+  fprintf(file, "  \"dropped\": %u,\n", stats.dropped);
+  fprintf(file, "  \"continuous\": %u,\n", stats.continuous);
+  fprintf(file, "  \"coalesced\": %u,\n", stats.coalesced);
+  fprintf(file, "  \"bytes\": %u,\n", stats.bytes);
+  fprintf(file, "  \"bytes_saved\": %u,\n", stats.bytes_saved);
+  fprintf(file, "  \"queue_high_water\": %u,\n", stats.high_water);
+  fprintf(file, "  \"filtered\": { \"smoothed\": %u, \"deadband\": %u, "
+    "\"interval\": %u },\n", 
+    filtered.smoothed, filtered.deadband, filtered.interval);
+  fprintf(file, "  \"debounced\": %u,\n", debounce_suppressed());
+  fprintf(file, "  \"collapsed\": %u,\n", input_collapsed());
+  fprintf(file, "  \"latency_us\": ");
+  histogram_write_json(file, &histograms.latency);
+  fprintf(file, ",\n  \"queue_depth\": ");
+  histogram_write_json(file, &histograms.depth);
+  fprintf(file, ",\n  \"process_ns\": ");
+  histogram_write_json(file, &histograms.process);
+  fprintf(file, "\n}\n");
+}
+
+int stats_write(const char *path) {
+  if (path == NULL) {
+    write_json(stdout);
+    fflush(stdout);
+    return(1);
+  }
+  // write next to the file and move it into place when it's complete
+  char temp_path[4096];
+  if (snprintf(temp_path, sizeof(temp_path), "%s.tmp", path) >= 
+        (int)sizeof(temp_path)) return(0);
+  FILE *file = fopen(temp_path, "w");
+  if (file == NULL) return(0);
+  write_json(file);
+  if (fclose(file) != 0) {
+    remove(temp_path);
+    return(0);
+  }
+  if (rename(temp_path, path) != 0) {
+    remove(temp_path);
+    return(0);
+  }
+  return(1);
+}
@@ -0,0 +1,10 @@
+#ifndef JOY2MIDI_STATS_H
+#define JOY2MIDI_STATS_H
+
+// write the output counters, filter counters and histograms as JSON to 
+//  the file at the given path, replacing it all at once so readers never 
+//  see a partial file, or to stdout if the path is NULL, returning 0 on 
+//  failure (not for the output thread, since it does I/O)
+int stats_write(const char *path);
+
+#endif
@@ -0,0 +1,109 @@
+// print the OSC bundles sent to a UDP port on this machine, for testing 
+//  joy2midi's OSC output
+
+#include <arpa/inet.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// how long to wait for each bundle before giving up
+#define TIMEOUT_MS 5000
+
+// read a 32-bit number in network byte order
+static uint32_t get_int32(const uint8_t *in) {
+  return(((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | 
+         ((uint32_t)in[2] << 8) | in[3]);
+}
+
+// get the size of a string with its terminator and padding, or 0 if it 
+//  runs past the end of the data
+static size_t string_size(const uint8_t *in, size_t size) {
+  size_t length = strnlen((const char *)in, size);
+  if (length >= size) return(0);
+  return((length + 4) & ~3);
+}
+
+// print a message's address and integer arguments, returning 0 if it's 
+//  malformed
+static int print_message(const uint8_t *in, size_t size) {
+  size_t i, address = string_size(in, size);
+  if (address == 0) return(0);
+  size_t tags = string_size(in + address, size - address);
+  if ((tags == 0) || (in[address] != ',')) return(0);
+  const char *tag = (const char *)in + address + 1;
+  const uint8_t *arg = in + address + tags;
+  printf("  %s", (const char *)in);
+  for (i = 0; tag[i] != '\0'; i++) {
+    if ((tag[i] != 'i') || (arg + 4 > in + size)) return(0);
+    printf(" %d", (int32_t)get_int32(arg));
+    arg += 4;
+  }
+  printf("\n");
+  return(1);
+}
+
+// print a bundle with its timetag in milliseconds after the first one's, 
+//  rounded to 10 ms so delivery jitter doesn't show, returning 0 if it's 
+//  malformed
+static int print_bundle(const uint8_t *in, size_t size, uint64_t *first) {
+  size_t offset;
+  if ((size < 16) || (memcmp(in, "#bundle", 8) != 0)) return(0);
+  uint64_t tag = ((uint64_t)get_int32(in + 8) << 32) | get_int32(in + 12);
+  if (*first == 0) *first = tag;
+  double ms = (double)(int64_t)(tag - *first) * 1000.0 / 4294967296.0;
+  printf("bundle +%.0f ms\n", round(ms / 10.0) * 10.0);
+  for (offset = 16; offset + 4 <= size; ) {
+    uint32_t length = get_int32(in + offset);
+    offset += 4;
+    if ((length > size - offset) || 
+        (! print_message(in + offset, length))) return(0);
+    offset += length;
+  }
+  return(offset == size);
+}
+
+int main(int argc, char **argv) {
+  uint8_t packet[2048];
+  uint64_t first = 0;
+  int i;
+  if (argc != 2) {
+    fprintf(stderr, "Usage: oscdump <bundles>\n");
+    return(2);
+  }
+  int count = atoi(argv[1]);
+  // listen on any free port and report which one it is
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in address;
+  socklen_t address_size = sizeof(address);
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if ((fd < 0) || 
+      (bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0) || 
+      (getsockname(fd, (struct sockaddr *)&address, &address_size) < 0)) {
+    fprintf(stderr, "ERROR: Failed to listen for OSC.\n");
+    return(1);
+  }
+  fprintf(stderr, "listening on %d\n", ntohs(address.sin_port));
+  for (i = 0; i < count; i++) {
+    struct pollfd ready = { fd, POLLIN, 0 };
+    if (poll(&ready, 1, TIMEOUT_MS) <= 0) {
+      fprintf(stderr, "ERROR: Timed out waiting for OSC.\n");
+      return(1);
+    }
+    ssize_t size = recv(fd, packet, sizeof(packet), 0);
+    if ((size < 0) || (! print_bundle(packet, size, &first))) {
+      fprintf(stderr, "ERROR: Received a malformed bundle.\n");
+      return(1);
+    }
+    fflush(stdout);
+  }
+  close(fd);
+  return(0);
+}
@@ -0,0 +1,112 @@
+#!/bin/sh
+# run the tests, which need neither JACK nor a joystick, reporting each one 
+#  and failing if any of them did (run from the joy2midi directory, which 
+#  `make test` does)
+
+joy2midi=./joy2midi
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+failures=0
+
+# compare what a test produced with what it should have
+check() {
+  if cmp -s "test/$1.expected" "$work/$1.result"; then
+    echo "pass: $1"
+  else
+    echo "FAIL: $1"
+    diff "test/$1.expected" "$work/$1.result" | sed 's/^/  /'
+    failures=$((failures + 1))
+  fi
+}
+
+# wait up to 5 seconds for a file to have at least the given number of bytes
+wait_for_size() {
+  tries=50
+  while [ "$(wc -c < "$1")" -lt "$2" ] && [ $tries -gt 0 ]; do
+    sleep 0.1
+    tries=$((tries - 1))
+  done
+}
+
+# wait up to 5 seconds for a line of output to appear in a file
+wait_for_line() {
+  tries=50
+  while ! grep -qs "$2" "$1" && [ $tries -gt 0 ]; do
+    sleep 0.1
+    tries=$((tries - 1))
+  done
+}
+
+# a FIFO stands in for a joystick: joy2midi opens it when it starts, reads 
+#  the events written to it and closes it when the writer goes away, 
+#  sending the button release it was still holding back
+test_device() {
+  mkfifo "$work/js0"
+  : > "$work/device.out"
+  stdbuf -oL $joy2midi --serial "$work/device.out" test/device.map \
+    "$work/js0" > "$work/device.log" 2>&1 &
+  pid=$!
+  wait_for_line "$work/device.log" "^Opened"
+  # events as the joystick API sends them: a time in milliseconds, a 
+  #  value, a type (1 for buttons, 2 for axes) and a number, written at 
+  #  once so they're read together
+  { printf '\000\000\000\000\001\000\001\000'; \
+    printf '\012\000\000\000\377\177\002\000'; \
+    printf '\024\000\000\000\000\000\001\000'; } > "$work/device.js"
+  cat "$work/device.js" > "$work/js0"
+  wait_for_line "$work/device.log" "^Closed"
+  wait_for_size "$work/device.out" 9
+  kill $pid
+  wait $pid 2> /dev/null
+  { sed "s|$work|DIR|g" "$work/device.log"; \
+    od -An -tx1 -v "$work/device.out"; } > "$work/device.result"
+  check device
+}
+
+# events from a gamepad's evdev device in the form `cat /dev/input/event<N>` 
+#  records them on a 64-bit machine, with scan codes before its buttons, 
+#  several changes in some reports and events lost to a SYN_DROPPED
+test_evdev() {
+  $joy2midi --replay test/evdev.events --evdev \
+    --output "$work/evdev.result" test/evdev.map
+  check evdev
+}
+
+# events written to a FIFO 200 ms apart go out as OSC bundles to a listener 
+#  on this machine, timetagged 200 ms apart to match when the events 
+#  happened, with messages for the named port in the same bundle
+test_osc() {
+  mkfifo "$work/js1"
+  test/oscdump 3 > "$work/osc.result" 2> "$work/oscdump.log" &
+  listener=$!
+  wait_for_line "$work/oscdump.log" "^listening"
+  port=$(sed -n 's/^listening on //p' "$work/oscdump.log")
+  stdbuf -oL $joy2midi --osc "127.0.0.1:$port" test/osc.map "$work/js1" \
+    > "$work/osc.log" 2>&1 &
+  pid=$!
+  wait_for_line "$work/osc.log" "^Opened"
+  # keep the FIFO open between writes so the device stays open
+  exec 3<> "$work/js1"
+  printf '\000\000\000\000\001\000\001\000\000\000\000\000\377\177\002\000' \
+    > "$work/osc.js" && cat "$work/osc.js" >&3
+  sleep 0.2
+  printf '\310\000\000\000\001\000\001\001\310\000\000\000\000\000\002\001' \
+    > "$work/osc.js" && cat "$work/osc.js" >&3
+  sleep 0.2
+  printf '\220\001\000\000\000\000\001\000' > "$work/osc.js" && \
+    cat "$work/osc.js" >&3
+  wait $listener
+  exec 3>&-
+  kill $pid
+  wait $pid 2> /dev/null
+  check osc
+}
+
+test_device
+test_evdev
+test_osc
+
+if [ $failures -gt 0 ]; then
+  echo "$failures failed"
+  exit 1
+fi
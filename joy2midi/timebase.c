@@ -0,0 +1,68 @@
+#include <math.h>
+
+#include "timebase.h"
+
+// the fraction of a positive error to correct on each observation, which 
+//  lets the estimate creep later when the kernel clock runs slow
+#define TIMEBASE_LEAK 0.001
+// the fraction of each correction to apply to the rate per unit of time
+#define TIMEBASE_RATE_GAIN 0.0001
+// the most the rate is allowed to deviate from nominal
+#define TIMEBASE_MAX_DRIFT 0.01
+// how far in microseconds timestamps can go backwards before we assume the 
+//  kernel clock wrapped or was reset and start over
+#define TIMEBASE_MAX_REWIND 1000000
+
+void timebase_init(Timebase *timebase, uint32_t sample_rate) {
+  timebase->initialized = 0;
+  timebase->nominal_rate = (double)sample_rate / 1000000.0;
+  timebase->rate = timebase->nominal_rate;
+  timebase->ref_time = 0;
+  timebase->ref_frame = 0;
+  timebase->ref_fraction = 0.0;
+}
+
+void timebase_observe(Timebase *timebase, uint64_t time, uint32_t now) {
+  int64_t elapsed = (int64_t)(time - timebase->ref_time);
+  if ((! timebase->initialized) || (elapsed < -TIMEBASE_MAX_REWIND)) {
+    timebase->ref_time = time;
+    timebase->ref_frame = now;
+    timebase->ref_fraction = 0.0;
+    timebase->initialized = 1;
+    return;
+  }
+  // predict the frame of the event from the last reference point
+  double predicted = timebase->ref_fraction + (timebase->rate * elapsed);
+  double error = (double)(int32_t)(now - timebase->ref_frame) - predicted;
+  // events can't be received before they happen, so a negative error means 
+  //  the estimate is too late and is corrected at once, while positive 
+  //  errors are mostly delivery delay and only nudge the estimate
+  double correction = (error < 0.0) ? error : error * TIMEBASE_LEAK;
+  // corrections that keep going the same way mean the clocks are drifting
+  if (elapsed > 0) {
+    timebase->rate += (correction / elapsed) * TIMEBASE_RATE_GAIN;
+    double max_drift = timebase->nominal_rate * TIMEBASE_MAX_DRIFT;
+    if (timebase->rate > timebase->nominal_rate + max_drift)
+      timebase->rate = timebase->nominal_rate + max_drift;
+    if (timebase->rate < timebase->nominal_rate - max_drift)
+      timebase->rate = timebase->nominal_rate - max_drift;
+  }
+  // move the reference point up to this event to keep offsets small
+  double frame = predicted + correction;
+  double whole = floor(frame);
+  timebase->ref_time = time;
+  timebase->ref_frame += (uint32_t)(int64_t)whole;
+  timebase->ref_fraction = frame - whole;
+}
+
+uint32_t timebase_frame(const Timebase *timebase, uint64_t time) {
+  int64_t elapsed = (int64_t)(time - timebase->ref_time);
+  double offset = timebase->ref_fraction + (timebase->rate * elapsed);
+  return(timebase->ref_frame + (uint32_t)(int64_t)floor(offset + 0.5));
+}
+
+uint64_t timebase_time(const Timebase *timebase, uint32_t frame) {
+  double offset = 
+    (double)(int32_t)(frame - timebase->ref_frame) - timebase->ref_fraction;
+  return(timebase->ref_time + (int64_t)floor(offset / timebase->rate));
+}
@@ -0,0 +1,30 @@
+#ifndef JOY2MIDI_TIMEBASE_H
+#define JOY2MIDI_TIMEBASE_H
+
+#include <stdint.h>
+
+// an estimator that maps microsecond timestamps from the kernel onto the 
+//  audio frame clock, tracking the drift between the two clocks
+typedef struct {
+  int initialized;
+  // the nominal number of frames per microsecond
+  double nominal_rate;
+  // the estimated number of frames per microsecond
+  double rate;
+  // a reference point where the two clocks are known to correspond
+  uint64_t ref_time;
+  uint32_t ref_frame;
+  double ref_fraction;
+} Timebase;
+
+// reset the estimator for the given sample rate
+void timebase_init(Timebase *timebase, uint32_t sample_rate);
+// refine the estimate with an event stamped at the given microsecond time 
+//  that was received when the frame clock read now
+void timebase_observe(Timebase *timebase, uint64_t time, uint32_t now);
+// get the estimated frame time corresponding to a microsecond timestamp
+uint32_t timebase_frame(const Timebase *timebase, uint64_t time);
+// get the estimated microsecond timestamp corresponding to a frame time
+uint64_t timebase_time(const Timebase *timebase, uint32_t frame);
+
+#endif
@@ -244,7 +244,8 @@ void Sync::_removeAllPoints() {
 void Sync::setPath(char *path) {
   if (path == NULL) return;
   if (strncmp(path, _path, sizeof(_path)) == 0) return;
-  strncpy(_path, path, sizeof(_path));
+  strncpy(_path, path, sizeof(_path) - 1);
+  _path[sizeof(_path) - 1] = '\0';
   // remove existing sync points
   _removeAllPoints();
   // reset block starts
@@ -13,7 +13,8 @@
 void Track::setPath(char *path) {
   if (path == NULL) return;
   if (strncmp(path, _path, sizeof(_path)) == 0) return;
-  strncpy(_path, path, sizeof(_path));
+  strncpy(_path, path, sizeof(_path) - 1);
+  _path[sizeof(_path) - 1] = '\0';
   INFO2("Track::setPath", _path);
   // delete the old scratch path to avoid confusion 
   //  when we load this loop again
@@ -169,7 +170,7 @@ void Track::update() {
   size_t beginSeq = _master->seq();
   audio_block_t *outBlock = _master->readBlock();
   if (! needsPlayback) {
-    release(outBlock);
+    if (outBlock) release(outBlock);
     outBlock = NULL;
   }
   // recompute the track's loop length once the first block is played
@@ -448,7 +449,8 @@ void PlayCache::readChunk() {
 }
 
 void FileCache::setPath(char *newPath) {
-  if ((newPath != NULL) && (strcmp(newPath, _path) == 0)) {
+  if ((newPath != NULL) && (_path != NULL) && 
+      (strcmp(newPath, _path) == 0)) {
     WARN2("FileCache::setPath path is NULL or unchanged", newPath);
     return;
   }
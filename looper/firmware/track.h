@@ -147,8 +147,9 @@ class Track : public AudioStream {
     bool _isActive;
     bool _isPassthru;
     char _path[64];
-    char _pathA[64];
-    char _pathB[64];
+    // room for the path plus a suffix
+    char _pathA[sizeof(_path) + 2];
+    char _pathB[sizeof(_path) + 2];
     PlayCache *_master;
     RecordCache *_scratch;
     audio_block_t *_inputQueueArray[1];
@@ -0,0 +1,93 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+// stand-ins for the parts of the Arduino/Teensy core the looper uses, 
+//  running on the simulated clock in sim.h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "sim.h"
+
+typedef uint8_t byte;
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+// the 5-bit binary constants used to draw LCD characters
+#define B00000 0
+#define B00001 1
+#define B00010 2
+#define B00011 3
+#define B00100 4
+#define B00101 5
+#define B00110 6
+#define B00111 7
+#define B01000 8
+#define B01001 9
+#define B01010 10
+#define B01011 11
+#define B01100 12
+#define B01101 13
+#define B01110 14
+#define B01111 15
+#define B10000 16
+#define B10001 17
+#define B10010 18
+#define B10011 19
+#define B10100 20
+#define B10101 21
+#define B10110 22
+#define B10111 23
+#define B11000 24
+#define B11001 25
+#define B11010 26
+#define B11011 27
+#define B11100 28
+#define B11101 29
+#define B11110 30
+#define B11111 31
+
+// pins read whatever level the simulation has set on them
+inline void pinMode(uint8_t pin, uint8_t mode) { }
+inline int digitalRead(uint8_t pin) { return(simPin(pin)); }
+
+inline unsigned long millis() { return(simTime() / 1000000); }
+inline unsigned long micros() { return(simTime() / 1000); }
+
+class elapsedMillis {
+  public:
+    elapsedMillis() { _start = millis(); }
+    elapsedMillis(unsigned long value) { _start = millis() - value; }
+    operator unsigned long() const { return(millis() - _start); }
+    elapsedMillis & operator=(unsigned long value) {
+      _start = millis() - value;
+      return(*this);
+    }
+  private:
+    unsigned long _start;
+};
+
+// serial output goes to stdout
+class SerialPort {
+  public:
+    void begin(long baud) { }
+    void print(const char *s) { fputs(s, stdout); }
+    void print(char c) { putchar(c); }
+    void print(int v) { printf("%d", v); }
+    void print(unsigned int v) { printf("%u", v); }
+    void print(long v) { printf("%ld", v); }
+    void print(unsigned long v) { printf("%lu", v); }
+    void print(double v) { printf("%.2f", v); }
+    template <typename T> void println(T v) { print(v); putchar('\n'); }
+    void println() { putchar('\n'); }
+};
+extern SerialPort Serial;
+
+#endif
@@ -0,0 +1,101 @@
+#include "Audio.h"
+
+float AudioInputI2S::amplitude = 0.0;
+float AudioInputI2S::frequency = 440.0;
+
+FILE *AudioOutputI2S::record = NULL;
+unsigned long AudioOutputI2S::blocks = 0;
+unsigned long AudioOutputI2S::silentBlocks = 0;
+int AudioOutputI2S::peak = 0;
+
+void AudioInputI2S::update() {
+  // look the wave up in a table so making input costs little next to the 
+  //  streams being measured
+  static int16_t wave[1024];
+  static bool hasWave = false;
+  if (! hasWave) {
+    for (int i = 0; i < 1024; i++) {
+      wave[i] = 32767 * sin((2.0 * M_PI * i) / 1024);
+    }
+    hasWave = true;
+  }
+  audio_block_t *block = allocate();
+  if (block == NULL) return;
+  uint32_t step = (uint32_t)((frequency * 4294967296.0) / 
+                             AUDIO_SAMPLE_RATE_EXACT);
+  float level = fabs(amplitude);
+  if (level > 32767) level = 32767;
+  int32_t scale = (int32_t)((level * 32768) / 32767);
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    block->data[i] = (wave[_phase >> 22] * scale) >> 15;
+    _phase += step;
+  }
+  transmit(block, 0);
+  transmit(block, 1);
+  release(block);
+}
+
+void AudioOutputI2S::update() {
+  static int16_t silence[AUDIO_BLOCK_SAMPLES];
+  audio_block_t *left = receiveReadOnly(0);
+  audio_block_t *right = receiveReadOnly(1);
+  if (left) release(left);
+  int16_t *data = right ? right->data : silence;
+  int blockPeak = 0;
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    int v = abs(data[i]);
+    if (v > blockPeak) blockPeak = v;
+  }
+  if (blockPeak > peak) peak = blockPeak;
+  if (blockPeak == 0) silentBlocks++;
+  blocks++;
+  if (record) fwrite(data, sizeof(int16_t), AUDIO_BLOCK_SAMPLES, record);
+  if (right) release(right);
+}
+
+void AudioMixer4::update() {
+  audio_block_t *out = NULL;
+  int32_t sum[AUDIO_BLOCK_SAMPLES];
+  for (int c = 0; c < 4; c++) {
+    audio_block_t *in = receiveReadOnly(c);
+    if (in == NULL) continue;
+    if (out == NULL) {
+      out = allocate();
+      if (out == NULL) {
+        release(in);
+        continue;
+      }
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) sum[i] = 0;
+    }
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      sum[i] += (int32_t)(in->data[i] * _gain[c]);
+    }
+    release(in);
+  }
+  if (out == NULL) return;
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    if (sum[i] > 32767) sum[i] = 32767;
+    else if (sum[i] < -32768) sum[i] = -32768;
+    out->data[i] = sum[i];
+  }
+  transmit(out, 0);
+  release(out);
+}
+
+void AudioAnalyzePeak::update() {
+  audio_block_t *block = receiveReadOnly(0);
+  if (block == NULL) return;
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    int v = abs(block->data[i]);
+    if (v > _peak) _peak = v;
+  }
+  _available = true;
+  release(block);
+}
+
+float AudioAnalyzePeak::read() {
+  float peak = _peak / 32767.0;
+  _peak = 0;
+  _available = false;
+  return(peak);
+}
@@ -0,0 +1,77 @@
+#ifndef SIM_AUDIO_H
+#define SIM_AUDIO_H
+
+// stand-ins for the Teensy audio library objects the looper uses
+
+#include <Arduino.h>
+#include "AudioStream.h"
+
+#define AUDIO_INPUT_LINEIN 0
+#define AUDIO_INPUT_MIC 1
+
+class AudioControlSGTL5000 {
+  public:
+    bool enable() { return(true); }
+    bool inputSelect(int n) { return(true); }
+    bool micGain(unsigned int dB) { return(true); }
+    bool lineInLevel(uint8_t n) { return(true); }
+    bool lineOutLevel(uint8_t n) { return(true); }
+    bool volume(float n) { return(true); }
+};
+
+// the input plays a sine wave at whatever amplitude and frequency the 
+//  simulation sets, on both channels
+class AudioInputI2S : public AudioStream {
+  public:
+    AudioInputI2S() : AudioStream(0, NULL) { _phase = 0; }
+    virtual void update();
+    static float amplitude;
+    static float frequency;
+  private:
+    uint32_t _phase;
+};
+
+// the output keeps track of what it would have played, and can write the 
+//  right channel to a file as raw 16-bit samples
+class AudioOutputI2S : public AudioStream {
+  public:
+    AudioOutputI2S() : AudioStream(2, _inputQueueArray) { }
+    virtual void update();
+    static FILE *record;
+    static unsigned long blocks;
+    static unsigned long silentBlocks;
+    static int peak;
+  private:
+    audio_block_t *_inputQueueArray[2];
+};
+
+class AudioMixer4 : public AudioStream {
+  public:
+    AudioMixer4() : AudioStream(4, _inputQueueArray) {
+      for (int i = 0; i < 4; i++) _gain[i] = 1.0;
+    }
+    virtual void update();
+    void gain(unsigned int channel, float gain) {
+      if (channel < 4) _gain[channel] = gain;
+    }
+  private:
+    audio_block_t *_inputQueueArray[4];
+    float _gain[4];
+};
+
+class AudioAnalyzePeak : public AudioStream {
+  public:
+    AudioAnalyzePeak() : AudioStream(1, _inputQueueArray) {
+      _peak = 0;
+      _available = false;
+    }
+    virtual void update();
+    bool available() { return(_available); }
+    float read();
+  private:
+    audio_block_t *_inputQueueArray[1];
+    int _peak;
+    bool _available;
+};
+
+#endif
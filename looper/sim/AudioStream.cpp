@@ -0,0 +1,139 @@
+#include "AudioStream.h"
+
+AudioStream *AudioStream::_firstUpdate = NULL;
+AudioStream *AudioStream::_lastUpdate = NULL;
+audio_block_t *AudioStream::_pool = NULL;
+audio_block_t **AudioStream::_free = NULL;
+unsigned int AudioStream::memory_used = 0;
+unsigned int AudioStream::memory_used_max = 0;
+unsigned int AudioStream::memory_total = 0;
+unsigned long AudioStream::allocate_failures = 0;
+unsigned long AudioStream::null_releases = 0;
+
+// CONNECTIONS ****************************************************************
+
+AudioConnection::AudioConnection(AudioStream &source, 
+    unsigned char sourceOutput, AudioStream &destination, 
+    unsigned char destinationInput) 
+    : _source(source), _destination(destination) {
+  _sourceOutput = sourceOutput;
+  _destinationInput = destinationInput;
+  _connect();
+}
+
+AudioConnection::AudioConnection(AudioStream &source, 
+    AudioStream &destination) 
+    : _source(source), _destination(destination) {
+  _sourceOutput = _destinationInput = 0;
+  _connect();
+}
+
+void AudioConnection::_connect() {
+  _next = NULL;
+  if (_destinationInput >= _destination._inputCount) return;
+  AudioConnection **p = &_source._destinations;
+  while (*p) p = &(*p)->_next;
+  *p = this;
+}
+
+// STREAMS ********************************************************************
+
+AudioStream::AudioStream(unsigned char ninput, audio_block_t **iqueue) {
+  _inputCount = ninput;
+  _inputQueue = iqueue;
+  for (int i = 0; i < ninput; i++) _inputQueue[i] = NULL;
+  _destinations = NULL;
+  updateNanos = updateCount = 0;
+  _nextUpdate = NULL;
+  if (_lastUpdate) _lastUpdate->_nextUpdate = this;
+  else _firstUpdate = this;
+  _lastUpdate = this;
+}
+
+void AudioStream::initialize_memory(unsigned int num) {
+  _pool = new audio_block_t[num];
+  _free = new audio_block_t *[num];
+  for (unsigned int i = 0; i < num; i++) {
+    _pool[i].memory_pool_index = i;
+    _free[i] = &_pool[num - i - 1];
+  }
+  memory_total = num;
+  memory_used = memory_used_max = 0;
+}
+
+void AudioStream::update_all() {
+  // find what reading the host clock twice costs, so it can be left out
+  static uint64_t overhead = UINT64_MAX;
+  if (overhead == UINT64_MAX) {
+    for (int i = 0; i < 100; i++) {
+      uint64_t start = simHostTime();
+      uint64_t nanos = simHostTime() - start;
+      if (nanos < overhead) overhead = nanos;
+    }
+  }
+  for (AudioStream *s = _firstUpdate; s; s = s->_nextUpdate) {
+    uint64_t start = simHostTime();
+    s->update();
+    uint64_t nanos = simHostTime() - start;
+    if (nanos > overhead) s->updateNanos += nanos - overhead;
+    s->updateCount++;
+  }
+}
+
+audio_block_t *AudioStream::allocate() {
+  if (memory_used >= memory_total) {
+    allocate_failures++;
+    return(NULL);
+  }
+  audio_block_t *block = _free[memory_total - memory_used - 1];
+  memory_used++;
+  if (memory_used > memory_used_max) memory_used_max = memory_used;
+  block->ref_count = 1;
+  return(block);
+}
+
+void AudioStream::release(audio_block_t *block) {
+  // a Teensy reads the start of flash for a NULL block, so this 
+  //  mostly gets away with it there
+  if (block == NULL) {
+    null_releases++;
+    return;
+  }
+  if (block->ref_count > 1) {
+    block->ref_count--;
+    return;
+  }
+  block->ref_count = 0;
+  memory_used--;
+  _free[memory_total - memory_used - 1] = block;
+}
+
+void AudioStream::transmit(audio_block_t *block, unsigned char index) {
+  for (AudioConnection *c = _destinations; c; c = c->_next) {
+    if (c->_sourceOutput != index) continue;
+    audio_block_t **queue = &c->_destination._inputQueue[c->_destinationInput];
+    // a block that hasn't been received yet stays put
+    if (*queue == NULL) {
+      *queue = block;
+      block->ref_count++;
+    }
+  }
+}
+
+audio_block_t *AudioStream::receiveReadOnly(unsigned int index) {
+  if (index >= _inputCount) return(NULL);
+  audio_block_t *block = _inputQueue[index];
+  _inputQueue[index] = NULL;
+  return(block);
+}
+
+audio_block_t *AudioStream::receiveWritable(unsigned int index) {
+  audio_block_t *block = receiveReadOnly(index);
+  if ((block) && (block->ref_count > 1)) {
+    audio_block_t *copy = allocate();
+    if (copy) memcpy(copy->data, block->data, sizeof(copy->data));
+    block->ref_count--;
+    block = copy;
+  }
+  return(block);
+}
@@ -0,0 +1,80 @@
+#ifndef SIM_AUDIO_STREAM_H
+#define SIM_AUDIO_STREAM_H
+
+// a stand-in for the Teensy audio library's stream base class, with blocks 
+//  shared by reference count from a fixed pool and updates run in the 
+//  order streams were made
+
+#include <Arduino.h>
+
+#define AUDIO_BLOCK_SAMPLES 128
+#define AUDIO_SAMPLE_RATE_EXACT 44117.64706
+#define AUDIO_SAMPLE_RATE AUDIO_SAMPLE_RATE_EXACT
+
+typedef struct audio_block_struct {
+  unsigned char ref_count;
+  unsigned char reserved1;
+  unsigned short memory_pool_index;
+  int16_t data[AUDIO_BLOCK_SAMPLES];
+} audio_block_t;
+
+class AudioStream;
+
+class AudioConnection {
+  public:
+    AudioConnection(AudioStream &source, unsigned char sourceOutput,
+                    AudioStream &destination, unsigned char destinationInput);
+    AudioConnection(AudioStream &source, AudioStream &destination);
+  private:
+    friend class AudioStream;
+    void _connect();
+    AudioStream &_source;
+    AudioStream &_destination;
+    unsigned char _sourceOutput;
+    unsigned char _destinationInput;
+    AudioConnection *_next;
+};
+
+#define AudioMemory(num) AudioStream::initialize_memory(num)
+#define AudioMemoryUsage() (AudioStream::memory_used)
+#define AudioMemoryUsageMax() (AudioStream::memory_used_max)
+
+class AudioStream {
+  public:
+    AudioStream(unsigned char ninput, audio_block_t **iqueue);
+    virtual void update() = 0;
+    // make the pool of blocks to allocate from
+    static void initialize_memory(unsigned int num);
+    // run one update of every stream, as the audio interrupt does each block
+    static void update_all();
+    // walk the streams in update order
+    static AudioStream *first() { return(_firstUpdate); }
+    AudioStream *next() { return(_nextUpdate); }
+    // the host time spent in this stream's updates and how many there were
+    uint64_t updateNanos;
+    uint64_t updateCount;
+    // pool usage, plus counts of things that work by accident on a Teensy
+    static unsigned int memory_used;
+    static unsigned int memory_used_max;
+    static unsigned int memory_total;
+    static unsigned long allocate_failures;
+    static unsigned long null_releases;
+  protected:
+    void transmit(audio_block_t *block, unsigned char index = 0);
+    audio_block_t *receiveReadOnly(unsigned int index = 0);
+    audio_block_t *receiveWritable(unsigned int index = 0);
+    static audio_block_t *allocate();
+    static void release(audio_block_t *block);
+  private:
+    friend class AudioConnection;
+    unsigned char _inputCount;
+    audio_block_t **_inputQueue;
+    AudioConnection *_destinations;
+    AudioStream *_nextUpdate;
+    static AudioStream *_firstUpdate;
+    static AudioStream *_lastUpdate;
+    static audio_block_t *_pool;
+    static audio_block_t **_free;
+};
+
+#endif
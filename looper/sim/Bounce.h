@@ -0,0 +1,43 @@
+#ifndef SIM_BOUNCE_H
+#define SIM_BOUNCE_H
+
+// a stand-in for version 1 of the Bounce library, debouncing a simulated 
+//  pin on the simulated clock
+
+#include <Arduino.h>
+
+class Bounce {
+  public:
+    Bounce(uint8_t pin, unsigned long interval_millis) {
+      _pin = pin;
+      _interval = interval_millis;
+      _previous = millis();
+      _state = digitalRead(pin);
+      _changed = false;
+    }
+    void interval(unsigned long interval_millis) { 
+      _interval = interval_millis;
+    }
+    int update() {
+      _changed = false;
+      uint8_t newState = digitalRead(_pin);
+      if ((newState != _state) && (millis() - _previous >= _interval)) {
+        _previous = millis();
+        _state = newState;
+        _changed = true;
+      }
+      return(_changed);
+    }
+    int read() { return(_state); }
+    unsigned long duration() { return(millis() - _previous); }
+    bool risingEdge() { return(_changed && _state); }
+    bool fallingEdge() { return(_changed && ! _state); }
+  private:
+    uint8_t _pin;
+    uint8_t _state;
+    bool _changed;
+    unsigned long _interval;
+    unsigned long _previous;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef SIM_EEPROM_H
+#define SIM_EEPROM_H
+
+// a stand-in for the EEPROM, which starts out erased on every run
+
+#include <Arduino.h>
+
+#define EEPROM_SIZE 2048
+
+class EEPROMClass {
+  public:
+    EEPROMClass() { memset(_data, 0xFF, sizeof(_data)); }
+    uint8_t read(int address) { 
+      if ((address < 0) || (address >= EEPROM_SIZE)) return(0xFF);
+      return(_data[address]);
+    }
+    void write(int address, uint8_t value) {
+      if ((address < 0) || (address >= EEPROM_SIZE)) return;
+      _data[address] = value;
+    }
+  private:
+    uint8_t _data[EEPROM_SIZE];
+};
+extern EEPROMClass EEPROM;
+
+#endif
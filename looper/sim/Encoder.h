@@ -0,0 +1,23 @@
+#ifndef SIM_ENCODER_H
+#define SIM_ENCODER_H
+
+// a stand-in for a rotary encoder, which the simulation turns by 
+//  changing its position
+
+#include <Arduino.h>
+
+class Encoder {
+  public:
+    Encoder(uint8_t pin1, uint8_t pin2) {
+      _position = 0;
+      last = this;
+    }
+    int32_t read() { return(_position); }
+    void write(int32_t p) { _position = p; }
+    // the most recently made encoder (the looper only has one)
+    static Encoder *last;
+  private:
+    int32_t _position;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef SIM_LIQUID_CRYSTAL_H
+#define SIM_LIQUID_CRYSTAL_H
+
+// a stand-in for a character LCD that keeps what it shows in memory
+
+#include <Arduino.h>
+
+#define LCD_MAX_COLS 20
+#define LCD_MAX_ROWS 4
+
+class LiquidCrystal {
+  public:
+    LiquidCrystal(uint8_t rs, uint8_t enable, 
+                  uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3) {
+      begin(16, 2);
+      last = this;
+    }
+    void begin(uint8_t cols, uint8_t rows) {
+      _cols = (cols < LCD_MAX_COLS) ? cols : LCD_MAX_COLS;
+      _rows = (rows < LCD_MAX_ROWS) ? rows : LCD_MAX_ROWS;
+      memset(_screen, ' ', sizeof(_screen));
+      _col = _row = 0;
+      changed = true;
+    }
+    void createChar(uint8_t location, uint8_t charmap[]) { }
+    void setCursor(uint8_t col, uint8_t row) {
+      _col = col;
+      _row = row;
+    }
+    void print(const char *s) { while (*s) write(*s++); }
+    void print(char c) { write(c); }
+    void print(int v) { print((long)v); }
+    void print(unsigned int v) { print((unsigned long)v); }
+    void print(long v) {
+      char buffer[24];
+      snprintf(buffer, sizeof(buffer), "%ld", v);
+      print(buffer);
+    }
+    void print(unsigned long v) {
+      char buffer[24];
+      snprintf(buffer, sizeof(buffer), "%lu", v);
+      print(buffer);
+    }
+    void print(double v) {
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), "%.2f", v);
+      print(buffer);
+    }
+    void write(char c) {
+      if ((_row < _rows) && (_col < _cols)) {
+        if (_screen[_row][_col] != c) changed = true;
+        _screen[_row][_col] = c;
+      }
+      _col++;
+    }
+    // get the character at a position
+    char at(uint8_t col, uint8_t row) { return(_screen[row][col]); }
+    uint8_t cols() { return(_cols); }
+    uint8_t rows() { return(_rows); }
+    // whether the screen changed since this was last cleared
+    bool changed;
+    // the most recently made LCD (the looper only has one)
+    static LiquidCrystal *last;
+  private:
+    char _screen[LCD_MAX_ROWS][LCD_MAX_COLS];
+    uint8_t _cols, _rows, _col, _row;
+};
+
+#endif
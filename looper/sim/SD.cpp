@@ -0,0 +1,114 @@
+#include "SD.h"
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SDClass SD;
+
+// FILES **********************************************************************
+
+uint32_t File::position() {
+  if (! _fp) return(0);
+  return(ftell(_fp));
+}
+
+bool File::seek(uint32_t pos) {
+  if (! _fp) return(false);
+  uint64_t start = simHostTime();
+  bool ok = (fseek(_fp, pos, SEEK_SET) == 0);
+  SD.hostNanos += simHostTime() - start;
+  SD.seeks++;
+  simStorageWait(simLatency.seek);
+  return(ok);
+}
+
+int File::read(void *buf, uint16_t nbyte) {
+  if (! _fp) return(-1);
+  uint64_t start = simHostTime();
+  size_t bytes = fread(buf, 1, nbyte, _fp);
+  SD.hostNanos += simHostTime() - start;
+  SD.reads++;
+  SD.bytesRead += bytes;
+  simStorageWait(simLatency.read);
+  return(bytes);
+}
+
+size_t File::write(const uint8_t *buf, size_t size) {
+  if (! _fp) return(0);
+  uint64_t start = simHostTime();
+  size_t bytes = fwrite(buf, 1, size, _fp);
+  long end = ftell(_fp);
+  if ((end > 0) && ((uint32_t)end > _size)) _size = end;
+  SD.hostNanos += simHostTime() - start;
+  SD.writes++;
+  SD.bytesWritten += bytes;
+  simStorageWait(simLatency.write);
+  return(bytes);
+}
+
+void File::flush() {
+  if (_fp) fflush(_fp);
+}
+
+void File::close() {
+  if (_fp) fclose(_fp);
+  _fp = NULL;
+  _size = 0;
+}
+
+// CARD ***********************************************************************
+
+void SDClass::_path(char *buffer, size_t size, const char *filepath) {
+  while (*filepath == '/') filepath++;
+  snprintf(buffer, size, "%s/%s", root, filepath);
+}
+
+bool SDClass::begin(uint8_t csPin) {
+  struct stat s;
+  if (root == NULL) return(false);
+  opens = reads = writes = seeks = 0;
+  bytesRead = bytesWritten = 0;
+  hostNanos = 0;
+  return((stat(root, &s) == 0) && (S_ISDIR(s.st_mode)));
+}
+
+File SDClass::open(const char *filepath, int mode) {
+  char path[1024];
+  File f;
+  _path(path, sizeof(path), filepath);
+  uint64_t start = simHostTime();
+  if (! (mode & O_WRITE)) f._fp = fopen(path, "rb");
+  else if (mode & O_TRUNC) f._fp = fopen(path, "w+b");
+  else {
+    f._fp = fopen(path, "r+b");
+    if ((f._fp == NULL) && (mode & O_CREAT)) f._fp = fopen(path, "w+b");
+  }
+  if (f._fp) {
+    fseek(f._fp, 0, SEEK_END);
+    f._size = ftell(f._fp);
+    fseek(f._fp, 0, SEEK_SET);
+  }
+  hostNanos += simHostTime() - start;
+  opens++;
+  simStorageWait(simLatency.open);
+  return(f);
+}
+
+bool SDClass::exists(const char *filepath) {
+  char path[1024];
+  _path(path, sizeof(path), filepath);
+  return(access(path, F_OK) == 0);
+}
+
+bool SDClass::mkdir(const char *filepath) {
+  char path[1024];
+  _path(path, sizeof(path), filepath);
+  return((::mkdir(path, 0777) == 0) || (errno == EEXIST));
+}
+
+bool SDClass::remove(const char *filepath) {
+  char path[1024];
+  _path(path, sizeof(path), filepath);
+  return(unlink(path) == 0);
+}
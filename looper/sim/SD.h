@@ -0,0 +1,56 @@
+#ifndef SIM_SD_H
+#define SIM_SD_H
+
+// a stand-in for the Teensy SD library that keeps the card's files in a 
+//  directory on the host, taking simulated time for each operation
+
+#include <Arduino.h>
+
+#define O_READ 0x01
+#define O_WRITE 0x02
+#ifndef O_CREAT
+  #define O_CREAT 0x10
+#endif
+#ifndef O_TRUNC
+  #define O_TRUNC 0x40
+#endif
+#define FILE_READ O_READ
+#define FILE_WRITE (O_READ | O_WRITE | O_CREAT)
+
+class File {
+  public:
+    File() { _fp = NULL; _size = 0; }
+    operator bool() { return(_fp != NULL); }
+    uint32_t size() { return(_size); }
+    uint32_t position();
+    bool seek(uint32_t pos);
+    int read(void *buf, uint16_t nbyte);
+    size_t write(const uint8_t *buf, size_t size);
+    void flush();
+    void close();
+  private:
+    friend class SDClass;
+    FILE *_fp;
+    uint32_t _size;
+};
+
+class SDClass {
+  public:
+    SDClass() { root = NULL; }
+    bool begin(uint8_t csPin);
+    File open(const char *filepath, int mode = FILE_READ);
+    bool exists(const char *filepath);
+    bool mkdir(const char *filepath);
+    bool remove(const char *filepath);
+    // the host directory that stands for the card
+    const char *root;
+    // counts of operations and the host time they took
+    unsigned long opens, reads, writes, seeks;
+    unsigned long bytesRead, bytesWritten;
+    uint64_t hostNanos;
+  private:
+    void _path(char *buffer, size_t size, const char *filepath);
+};
+extern SDClass SD;
+
+#endif
@@ -0,0 +1 @@
+#include "SD.h"
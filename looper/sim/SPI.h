@@ -0,0 +1,16 @@
+#ifndef SIM_SPI_H
+#define SIM_SPI_H
+
+// a stand-in for the SPI bus, which only needs its pins set
+
+#include <Arduino.h>
+
+class SPIClass {
+  public:
+    void setMOSI(uint8_t pin) { }
+    void setMISO(uint8_t pin) { }
+    void setSCK(uint8_t pin) { }
+};
+extern SPIClass SPI;
+
+#endif
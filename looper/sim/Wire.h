@@ -0,0 +1,9 @@
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+// the audio shield's control port is simulated by AudioControlSGTL5000, 
+//  so nothing else uses I2C
+
+#include <Arduino.h>
+
+#endif
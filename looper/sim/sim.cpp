@@ -0,0 +1,428 @@
+#include <getopt.h>
+#include <time.h>
+#include <errno.h>
+#include <cxxabi.h>
+#include <sys/stat.h>
+#include <typeinfo>
+
+#include <Arduino.h>
+#include <Audio.h>
+#include <SD.h>
+#include <SPI.h>
+#include <EEPROM.h>
+#include <Encoder.h>
+#include <LiquidCrystal.h>
+
+// the firmware's entry points
+void setup();
+void loop();
+
+// where the firmware wires its foot switches and mode button
+#define SWITCH_COUNT 4
+static const uint8_t switchPins[SWITCH_COUNT] = { 30, 31, 32, 33 };
+#define BUTTON_PIN 3
+// how long a tap holds a switch down, in milliseconds
+#define TAP_MILLISECONDS 100
+// the most events a script can have
+#define MAX_EVENTS 4096
+
+// STAND-INS ******************************************************************
+
+SerialPort Serial;
+SPIClass SPI;
+EEPROMClass EEPROM;
+Encoder *Encoder::last = NULL;
+LiquidCrystal *LiquidCrystal::last = NULL;
+SimLatency simLatency = { 0, 0, 0, 0, 0 };
+
+// CLOCK **********************************************************************
+
+static uint64_t now = 0;
+static uint64_t blocks = 0;
+static uint64_t nextBlock = 0;
+static uint64_t audioNanos = 0;
+
+// get the simulated time a block is due, computed from the block count so
+//  the fractional block period doesn't drift
+static uint64_t blockTime(uint64_t block) {
+  return((uint64_t)((block * AUDIO_BLOCK_SAMPLES * 1000000000.0) /
+                    AUDIO_SAMPLE_RATE_EXACT));
+}
+
+uint64_t simTime() { return(now); }
+
+uint64_t simHostTime() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return(((uint64_t)t.tv_sec * 1000000000) + t.tv_nsec);
+}
+
+void simWait(uint64_t nanos) {
+  uint64_t until = now + nanos;
+  while (nextBlock <= until) {
+    now = nextBlock;
+    uint64_t start = simHostTime();
+    AudioStream::update_all();
+    audioNanos += simHostTime() - start;
+    blocks++;
+    nextBlock = blockTime(blocks + 1);
+  }
+  now = until;
+}
+
+void simStorageWait(uint32_t micros) {
+  if (simLatency.jitter > 0) micros += random() % (simLatency.jitter + 1);
+  simWait((uint64_t)micros * 1000);
+}
+
+// PINS ***********************************************************************
+
+static uint8_t pinLevels[64];
+
+int simPin(uint8_t pin) {
+  if (pin >= sizeof(pinLevels)) return(HIGH);
+  return(pinLevels[pin] ? LOW : HIGH);
+}
+
+void simSetPin(uint8_t pin, int level) {
+  if (pin >= sizeof(pinLevels)) return;
+  // store pins inverted so they all float high to start with
+  pinLevels[pin] = (level == LOW);
+}
+
+// SCRIPTS ********************************************************************
+
+typedef enum {
+  Press,
+  Release,
+  Turn,
+  Input
+} EventType;
+
+typedef struct {
+  uint64_t time;
+  EventType type;
+  int pin;
+  float value;
+  float frequency;
+  int order;
+} Event;
+
+static Event events[MAX_EVENTS];
+static int eventCount = 0;
+
+static Event *addEvent(uint64_t time, EventType type) {
+  if (eventCount >= MAX_EVENTS) return(NULL);
+  Event *e = &events[eventCount++];
+  e->time = time;
+  e->type = type;
+  e->pin = -1;
+  e->value = e->frequency = 0.0;
+  e->order = eventCount;
+  return(e);
+}
+
+static int compareEvents(const void *a, const void *b) {
+  const Event *ea = (const Event *)a;
+  const Event *eb = (const Event *)b;
+  if (ea->time != eb->time) return((ea->time < eb->time) ? -1 : 1);
+  // keep events at the same time in the order they were given
+  return(ea->order - eb->order);
+}
+
+// get the pin for a foot switch number or "button"
+static int targetPin(const char *target) {
+  char *end;
+  if (strcmp(target, "button") == 0) return(BUTTON_PIN);
+  long i = strtol(target, &end, 10);
+  if ((*end != '\0') || (i < 0) || (i >= SWITCH_COUNT)) return(-1);
+  return(switchPins[i]);
+}
+
+// read a script of lines like "<seconds> <action> [<argument> ...]"
+static int readScript(const char *path) {
+  char line[256], action[32], arg1[32], arg2[32];
+  double seconds;
+  int lineNumber = 0;
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    fprintf(stderr, "ERROR: Unable to open %s: %s\n", path, strerror(errno));
+    return(0);
+  }
+  while (fgets(line, sizeof(line), f)) {
+    lineNumber++;
+    char *comment = strchr(line, '#');
+    if (comment) *comment = '\0';
+    arg1[0] = arg2[0] = '\0';
+    int fields = sscanf(line, "%lf %31s %31s %31s",
+                        &seconds, action, arg1, arg2);
+    if (fields <= 0) continue;
+    if ((fields < 2) || (seconds < 0.0)) {
+      fprintf(stderr, "ERROR: %s:%d: Expected a time and an action.\n",
+              path, lineNumber);
+      fclose(f);
+      return(0);
+    }
+    uint64_t time = (uint64_t)(seconds * 1000000000.0);
+    Event *e = NULL;
+    int pin = targetPin(arg1);
+    if ((strcmp(action, "press") == 0) || (strcmp(action, "release") == 0) ||
+        (strcmp(action, "tap") == 0)) {
+      if (pin < 0) {
+        fprintf(stderr, "ERROR: %s:%d: Expected a switch from 0 to %d "
+                "or \"button\".\n", path, lineNumber, SWITCH_COUNT - 1);
+        fclose(f);
+        return(0);
+      }
+      if (action[0] == 'r') e = addEvent(time, Release);
+      else e = addEvent(time, Press);
+      if (e) e->pin = pin;
+      if (action[0] == 't') {
+        e = addEvent(time + (TAP_MILLISECONDS * 1000000), Release);
+        if (e) e->pin = pin;
+      }
+    }
+    else if ((strcmp(action, "turn") == 0) && (fields >= 3)) {
+      e = addEvent(time, Turn);
+      if (e) e->value = atof(arg1);
+    }
+    else if ((strcmp(action, "input") == 0) && (fields >= 3)) {
+      e = addEvent(time, Input);
+      if (e) {
+        e->value = atof(arg1);
+        e->frequency = (fields >= 4) ? atof(arg2) : 0.0;
+      }
+    }
+    else {
+      fprintf(stderr, "ERROR: %s:%d: Unknown action \"%s\".\n",
+              path, lineNumber, action);
+      fclose(f);
+      return(0);
+    }
+    if (e == NULL) {
+      fprintf(stderr, "ERROR: %s:%d: Too many events (the limit is %d).\n",
+              path, lineNumber, MAX_EVENTS);
+      fclose(f);
+      return(0);
+    }
+  }
+  fclose(f);
+  qsort(events, eventCount, sizeof(Event), compareEvents);
+  return(1);
+}
+
+static void runEvent(Event *e) {
+  switch (e->type) {
+    case Press: simSetPin(e->pin, LOW); break;
+    case Release: simSetPin(e->pin, HIGH); break;
+    case Turn:
+      // each detent of the encoder is 4 counts
+      if (Encoder::last) {
+        Encoder::last->write(Encoder::last->read() + (int32_t)(e->value * 4));
+      }
+      break;
+    case Input:
+      AudioInputI2S::amplitude = e->value;
+      if (e->frequency > 0.0) AudioInputI2S::frequency = e->frequency;
+      break;
+  }
+}
+
+// OUTPUT *********************************************************************
+
+// show the looper's custom LCD characters with something close
+static char lcdGlyph(char c) {
+  static const char glyphs[8] = { ' ', '#', ':', '*', '>', '=', 'd', ' ' };
+  if ((c >= 0) && (c < 8)) return(glyphs[(int)c]);
+  if ((c < 32) || (c > 126)) return('?');
+  return(c);
+}
+
+static void showLcd(LiquidCrystal *lcd) {
+  printf("%9.3f", simTime() / 1000000000.0);
+  for (uint8_t y = 0; y < lcd->rows(); y++) {
+    printf("%s|", (y == 0) ? " " : "          ");
+    for (uint8_t x = 0; x < lcd->cols(); x++) putchar(lcdGlyph(lcd->at(x, y)));
+    printf("|\n");
+  }
+  lcd->changed = false;
+}
+
+static void report(uint64_t hostNanos, uint64_t loops, uint64_t loopNanos) {
+  double seconds = simTime() / 1000000000.0;
+  double hostSeconds = hostNanos / 1000000000.0;
+  printf("Simulated %.2f s (%llu blocks) in %.3f s, %.1fx real time\n",
+         seconds, (unsigned long long)blocks, hostSeconds,
+         (hostSeconds > 0.0) ? seconds / hostSeconds : 0.0);
+  if (blocks == 0) return;
+  printf("Audio update: %llu ns per block\n",
+         (unsigned long long)(audioNanos / blocks));
+  // total the update time of each kind of stream
+  AudioStream *s, *t;
+  for (s = AudioStream::first(); s; s = s->next()) {
+    if (s->updateCount == 0) continue;
+    // skip kinds that were already counted
+    for (t = AudioStream::first(); t != s; t = t->next()) {
+      if ((t->updateCount > 0) && (typeid(*t) == typeid(*s))) break;
+    }
+    if (t != s) continue;
+    uint64_t nanos = 0;
+    int count = 0;
+    for (t = s; t; t = t->next()) {
+      if (typeid(*t) != typeid(*s)) continue;
+      nanos += t->updateNanos;
+      count++;
+    }
+    int status;
+    char *name = abi::__cxa_demangle(typeid(*s).name(), NULL, NULL, &status);
+    printf("  %-18s %6llu ns per block (%d of them)\n",
+           name ? name : typeid(*s).name(),
+           (unsigned long long)(nanos / blocks), count);
+    free(name);
+  }
+  if (loops > 0) {
+    printf("Loop: %llu passes, %llu ns each\n", (unsigned long long)loops,
+           (unsigned long long)(loopNanos / loops));
+  }
+  unsigned long ops = SD.opens + SD.reads + SD.writes + SD.seeks;
+  printf("SD: %lu opens, %lu reads (%lu bytes), %lu writes (%lu bytes), "
+         "%lu seeks, %llu ns each\n", SD.opens, SD.reads, SD.bytesRead,
+         SD.writes, SD.bytesWritten, SD.seeks,
+         (unsigned long long)(ops ? SD.hostNanos / ops : 0));
+  printf("Audio memory: %u of %u blocks used at most, %lu allocations "
+         "failed\n", AudioMemoryUsageMax(), AudioStream::memory_total,
+         AudioStream::allocate_failures);
+  if (AudioStream::null_releases > 0) {
+    printf("WARNING: Released %lu NULL blocks.\n", AudioStream::null_releases);
+  }
+  printf("Output: %lu blocks, %lu silent, peak %d\n", AudioOutputI2S::blocks,
+         AudioOutputI2S::silentBlocks, AudioOutputI2S::peak);
+}
+
+// MAIN ***********************************************************************
+
+int main(int argc, char *argv[]) {
+  int option;
+  const char *card = "card";
+  const char *output_path = NULL;
+  double seconds = -1.0;
+  long loop_cost = 50;
+  long seed = 1;
+  int show_lcd = 0;
+  static struct option options[] = {
+    { "card",   required_argument, NULL, 'c' },
+    { "seconds", required_argument, NULL, 's' },
+    { "open-latency", required_argument, NULL, 'O' },
+    { "read-latency", required_argument, NULL, 'R' },
+    { "write-latency", required_argument, NULL, 'W' },
+    { "seek-latency", required_argument, NULL, 'S' },
+    { "jitter", required_argument, NULL, 'J' },
+    { "seed",   required_argument, NULL, 'e' },
+    { "loop-cost", required_argument, NULL, 'l' },
+    { "output", required_argument, NULL, 'o' },
+    { "lcd",    no_argument,       NULL, 'L' },
+    { NULL, 0, NULL, 0 }
+  };
+
+  // check arguments
+  while ((option = getopt_long(argc, argv, "", options, NULL)) != -1) {
+    switch (option) {
+      case 'c': card = optarg; break;
+      case 's': seconds = atof(optarg); break;
+      case 'O': simLatency.open = strtoul(optarg, NULL, 10); break;
+      case 'R': simLatency.read = strtoul(optarg, NULL, 10); break;
+      case 'W': simLatency.write = strtoul(optarg, NULL, 10); break;
+      case 'S': simLatency.seek = strtoul(optarg, NULL, 10); break;
+      case 'J': simLatency.jitter = strtoul(optarg, NULL, 10); break;
+      case 'e': seed = strtol(optarg, NULL, 10); break;
+      case 'l': loop_cost = strtol(optarg, NULL, 10); break;
+      case 'o': output_path = optarg; break;
+      case 'L': show_lcd = 1; break;
+      default: return(1);
+    }
+  }
+  if (optind >= argc) {
+    printf("\n"
+    "Usage: looper-sim [options] <script>\n"
+    "\n"
+    "  Runs the looper firmware against a script of lines like\n"
+    "  \"<seconds> <action> [<argument> ...]\", where the action is one of:\n"
+    "\n"
+    "    press <switch>   Hold down a foot switch (0 to 3) or \"button\".\n"
+    "    release <switch> Let go of a foot switch or the button.\n"
+    "    tap <switch>     Press and release a foot switch or the button.\n"
+    "    turn <detents>   Turn the encoder (negative to turn it back).\n"
+    "    input <amplitude> [<hz>]\n"
+    "                     Play a sine wave into the input (0 for silence).\n"
+    "\n"
+    "Options:\n"
+    "  --card <dir>     Directory standing in for the SD card (./card).\n"
+    "  --seconds <s>    Simulated seconds to run (one past the last event).\n"
+    "  --open-latency <us>, --read-latency <us>, --write-latency <us>,\n"
+    "  --seek-latency <us>\n"
+    "                   Simulated microseconds each SD operation takes (0).\n"
+    "  --jitter <us>    Up to this many more microseconds at random per\n"
+    "                   SD operation (0).\n"
+    "  --seed <n>       Seed for the jitter (1).\n"
+    "  --loop-cost <us> Simulated microseconds each pass through the main\n"
+    "                   loop takes, not counting SD operations (50).\n"
+    "  --output <file>  Write what the looper plays as raw 16-bit samples.\n"
+    "  --lcd            Show the LCD whenever it changes.\n"
+    "\n");
+    return(1);
+  }
+  if ((seconds != -1.0) && (seconds <= 0.0)) {
+    fprintf(stderr, "ERROR: The number of seconds must be positive.\n");
+    return(1);
+  }
+  if (loop_cost <= 0) {
+    fprintf(stderr, "ERROR: The loop cost must be positive.\n");
+    return(1);
+  }
+  if (! readScript(argv[optind])) return(1);
+  if (seconds < 0.0) {
+    seconds = 1.0;
+    if (eventCount > 0) seconds += events[eventCount - 1].time / 1000000000.0;
+  }
+  if ((mkdir(card, 0777) != 0) && (errno != EEXIST)) {
+    fprintf(stderr, "ERROR: Unable to make %s: %s\n", card, strerror(errno));
+    return(1);
+  }
+  if (output_path) {
+    AudioOutputI2S::record = fopen(output_path, "wb");
+    if (AudioOutputI2S::record == NULL) {
+      fprintf(stderr, "ERROR: Unable to open %s: %s\n",
+              output_path, strerror(errno));
+      return(1);
+    }
+  }
+  SD.root = card;
+  srandom(seed);
+
+  // run the firmware, letting the audio interrupt happen between passes
+  //  through the main loop and during SD operations
+  uint64_t end = (uint64_t)(seconds * 1000000000.0);
+  uint64_t loops = 0, loopNanos = 0;
+  uint64_t hostStart = simHostTime();
+  int nextEvent = 0;
+  setup();
+  while (simTime() < end) {
+    while ((nextEvent < eventCount) && (events[nextEvent].time <= simTime())) {
+      runEvent(&events[nextEvent++]);
+    }
+    uint64_t start = simHostTime();
+    uint64_t audioStart = audioNanos;
+    loop();
+    loopNanos += (simHostTime() - start) - (audioNanos - audioStart);
+    loops++;
+    if ((show_lcd) && (LiquidCrystal::last) &&
+        (LiquidCrystal::last->changed)) {
+      showLcd(LiquidCrystal::last);
+    }
+    simWait((uint64_t)loop_cost * 1000);
+  }
+  uint64_t hostNanos = simHostTime() - hostStart;
+  if (AudioOutputI2S::record) fclose(AudioOutputI2S::record);
+  report(hostNanos, loops, loopNanos);
+  return(0);
+}
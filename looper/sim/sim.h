@@ -0,0 +1,31 @@
+#ifndef SIM_SIM_H
+#define SIM_SIM_H
+
+#include <stdint.h>
+
+// get the simulated time in nanoseconds since startup
+uint64_t simTime();
+// let simulated time pass, running an audio update for each block that 
+//  comes due along the way like the audio interrupt would
+void simWait(uint64_t nanos);
+// get the host time in nanoseconds, for measuring what things cost
+uint64_t simHostTime();
+
+// get/set the level on a digital pin (pins float high by default)
+int simPin(uint8_t pin);
+void simSetPin(uint8_t pin, int level);
+
+// how many microseconds of simulated time storage operations take, 
+//  with up to jitter microseconds more chosen at random for each one
+typedef struct {
+  uint32_t open;
+  uint32_t read;
+  uint32_t write;
+  uint32_t seek;
+  uint32_t jitter;
+} SimLatency;
+extern SimLatency simLatency;
+// wait for a storage operation with the given latency
+void simStorageWait(uint32_t micros);
+
+#endif